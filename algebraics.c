@@ -4,7 +4,8 @@
 #include "algebraics.h"
 #include "minpoly.h"
 #include "resultant.h"
-#include "factoring.h"
+#include "composed.h"
+#include "integers.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
@@ -12,10 +13,16 @@
 
 /* ---------- Constructors ---------- */
 
+// sets the minimal polynomial of a, which may be NULL, and tests whether it is irreducible
+static void set_minimal_polynomial(algebraic *a, polynomial *p) {
+	a->minimal_polynomial = p;
+	a->irreducible = (p == NULL) ? IRREDUCIBILITY_UNKNOWN : test_irreducibility(*p);
+}
+
 static algebraic *ball_to_algebraic(ball b) {
 	algebraic *result = (algebraic*) malloc(sizeof(algebraic));
 	result->approx_val = *new_ball(b.center, b.radius);
-	result->minimal_polynomial = NULL;
+	set_minimal_polynomial(result, NULL);
 	
 	return result;
 }
@@ -35,7 +42,7 @@ static algebraic *polynomial_to_algebraic(polynomial p, root_type error_bnd) {
 	// create the algebraic
 	algebraic *result = (algebraic*) malloc(sizeof(algebraic));
 	result->approx_val = roots->roots[root_selected];
-	result->minimal_polynomial = copy_polynomial(p);
+	set_minimal_polynomial(result, copy_polynomial(p));
 	// free intermediates
 	free_root_list(roots);
 	
@@ -46,7 +53,7 @@ static algebraic *polynomial_to_algebraic(polynomial p, root_type error_bnd) {
 static algebraic *both_to_algebraic(polynomial p, ball b) {
 	algebraic *result = (algebraic*) malloc(sizeof(algebraic));
 	result->approx_val = *new_ball(b.center, b.radius);
-	result->minimal_polynomial = copy_polynomial(p);
+	set_minimal_polynomial(result, copy_polynomial(p));
 	
 	return result;
 }
@@ -68,6 +75,7 @@ algebraic *copy_algebraic(algebraic a) {
 	} else {
 		result->minimal_polynomial = copy_polynomial(*(a.minimal_polynomial));
 	}
+	result->irreducible = a.irreducible;
 	
 	return result;
 }
@@ -78,7 +86,7 @@ algebraic *copy_algebraic(algebraic a) {
 // if get_min_poly does not find a minimal polynomial, it remains undefined
 void define_minimal_polynomial(algebraic *a, int max_k, int max_deg) {
 	if (a->minimal_polynomial == NULL)
-		a->minimal_polynomial = get_min_poly(a->approx_val, max_k, max_deg);
+		set_minimal_polynomial(a, get_min_poly(a->approx_val, max_k, max_deg));
 }
 
 // check whether an algebraic number is uniquely defined
@@ -113,16 +121,34 @@ void refine_approx_val(algebraic *a, root_type error) {
 
 /* ---------- Algebraic Arithmetic ---------- */
 
+// sets the minimal polynomial of result from a resultant vanishing at it
+// if the resultant is known to be irreducible up to its content, it is used directly, and otherwise the factor with a root at result is found
+static void set_from_resultant(algebraic *result, polynomial resultant, int known_irreducible) {
+	if (known_irreducible) {
+		result->minimal_polynomial = primitive_part(resultant);
+		result->irreducible = IRREDUCIBILITY_IRREDUCIBLE;
+	} else {
+		set_minimal_polynomial(result, find_factor(resultant, result->approx_val));
+	}
+}
+
 algebraic *add_algebraics(algebraic a, algebraic b) {
 	algebraic *result = (algebraic*) malloc(sizeof(algebraic));
 	result->approx_val = *new_ball(a.approx_val.center + b.approx_val.center, a.approx_val.radius + b.approx_val.radius);
 	// if the minimal polynomials are not null, take their resultant
 	if ((a.minimal_polynomial != NULL) && (b.minimal_polynomial != NULL)) {
 		polynomial *min_poly_unfactored = resultant_sum(*(a.minimal_polynomial), *(b.minimal_polynomial));
-		result->minimal_polynomial = find_factor(*min_poly_unfactored, result->approx_val);
-		free_polynomial(min_poly_unfactored);
+		// by a theorem of isaacs, a + b has degree deg(a)*deg(b) when the degrees are coprime, so the resultant is irreducible
+		int known_irreducible = (a.irreducible == IRREDUCIBILITY_IRREDUCIBLE) && (b.irreducible == IRREDUCIBILITY_IRREDUCIBLE)
+				&& (gcd(a.minimal_polynomial->deg, b.minimal_polynomial->deg) == 1);
+		if (min_poly_unfactored != NULL) {
+			set_from_resultant(result, *min_poly_unfactored, known_irreducible);
+			free_polynomial(min_poly_unfactored);
+		} else {
+			set_minimal_polynomial(result, NULL);	// only the approximation is known
+		}
 	} else {
-		result->minimal_polynomial = NULL;
+		set_minimal_polynomial(result, NULL);
 	}
 	
 	return result;
@@ -136,6 +162,7 @@ algebraic *negate_algebraic(algebraic a) {
 	} else {
 		result->minimal_polynomial = linear_change_of_variables(*(a.minimal_polynomial), -1, 0);
 	}
+	result->irreducible = a.irreducible;
 	
 	return result;
 }
@@ -148,6 +175,11 @@ algebraic *subtract_algebraics(algebraic a, algebraic b) {
 	return result;
 }
 
+// returns 1 if the minimal polynomial of a is linear with a nonzero root
+static int is_nonzero_rational(algebraic a) {
+	return (a.minimal_polynomial->deg == 1) && (a.minimal_polynomial->coefficients[1] != 0);
+}
+
 algebraic *mult_algebraics(algebraic a, algebraic b) {
 	algebraic *result = (algebraic*) malloc(sizeof(algebraic));
 	// compute the new error
@@ -156,10 +188,17 @@ algebraic *mult_algebraics(algebraic a, algebraic b) {
 	// if the minimal polynomials are not null, take their resultant
 	if ((a.minimal_polynomial != NULL) && (b.minimal_polynomial != NULL)) {
 		polynomial *min_poly_unfactored = resultant_product(*(a.minimal_polynomial), *(b.minimal_polynomial));
-		result->minimal_polynomial = find_factor(*min_poly_unfactored, result->approx_val);
-		free_polynomial(min_poly_unfactored);
+		// coprime degrees do not suffice for products, but a nonzero rational times b is conjugate to b
+		int known_irreducible = (a.irreducible == IRREDUCIBILITY_IRREDUCIBLE) && (b.irreducible == IRREDUCIBILITY_IRREDUCIBLE)
+				&& (is_nonzero_rational(a) || is_nonzero_rational(b));
+		if (min_poly_unfactored != NULL) {
+			set_from_resultant(result, *min_poly_unfactored, known_irreducible);
+			free_polynomial(min_poly_unfactored);
+		} else {
+			set_minimal_polynomial(result, NULL);	// only the approximation is known
+		}
 	} else {
-		result->minimal_polynomial = NULL;
+		set_minimal_polynomial(result, NULL);
 	}
 	
 	return result;
@@ -177,6 +216,7 @@ algebraic *invert_algebraic(algebraic a) {
 	} else {
 		result->minimal_polynomial = reverse_polynomial(*(a.minimal_polynomial));
 	}
+	result->irreducible = a.irreducible;
 	
 	return result;
 }
@@ -189,6 +229,160 @@ algebraic *divide_algebraics(algebraic a, algebraic b) {
 	return result;
 }
 
+/* ---------- Expressions ---------- */
+
+algebraic_expr *leaf_expr(algebraic *a) {
+	algebraic_expr *result = (algebraic_expr*) malloc(sizeof(algebraic_expr));
+	result->op = EXPR_LEAF;
+	result->leaf = a;
+	result->left = result->right = NULL;
+	
+	return result;
+}
+
+algebraic_expr *unary_expr(expr_op op, algebraic_expr *operand) {
+	assert((op == EXPR_NEGATE) || (op == EXPR_INVERT));
+	algebraic_expr *result = (algebraic_expr*) malloc(sizeof(algebraic_expr));
+	result->op = op;
+	result->leaf = NULL;
+	result->left = operand;
+	result->right = NULL;
+	
+	return result;
+}
+
+algebraic_expr *binary_expr(expr_op op, algebraic_expr *left, algebraic_expr *right) {
+	assert((op == EXPR_ADD) || (op == EXPR_SUBTRACT) || (op == EXPR_MULT) || (op == EXPR_DIVIDE));
+	algebraic_expr *result = (algebraic_expr*) malloc(sizeof(algebraic_expr));
+	result->op = op;
+	result->leaf = NULL;
+	result->left = left;
+	result->right = right;
+	
+	return result;
+}
+
+// frees the nodes of an expression, but not the algebraics at its leaves
+void free_algebraic_expr(algebraic_expr *e) {
+	if (e->left != NULL)
+		free_algebraic_expr(e->left);
+	if (e->right != NULL)
+		free_algebraic_expr(e->right);
+	free(e);
+}
+
+// evaluates e one operation at a time with the functions above
+// if approx_only is set, the minimal polynomials are ignored and only the approximate value is computed
+static algebraic *eval_expr_stepwise(algebraic_expr e, int approx_only) {
+	if (e.op == EXPR_LEAF) {
+		if (approx_only)
+			return ball_to_algebraic(e.leaf->approx_val);
+		return copy_algebraic(*(e.leaf));
+	}
+	algebraic *left = eval_expr_stepwise(*(e.left), approx_only), *right = NULL, *result;
+	if (e.right != NULL)
+		right = eval_expr_stepwise(*(e.right), approx_only);
+	switch (e.op) {
+		case EXPR_ADD:
+			result = add_algebraics(*left, *right);
+			break;
+		case EXPR_SUBTRACT:
+			result = subtract_algebraics(*left, *right);
+			break;
+		case EXPR_MULT:
+			result = mult_algebraics(*left, *right);
+			break;
+		case EXPR_DIVIDE:
+			result = divide_algebraics(*left, *right);
+			break;
+		case EXPR_NEGATE:
+			result = negate_algebraic(*left);
+			break;
+		default:
+			result = invert_algebraic(*left);
+	}
+	free_algebraic(left);
+	if (right != NULL)
+		free_algebraic(right);
+	
+	return result;
+}
+
+// returns 1 if the minimal polynomial of every leaf of e is known, and 0 otherwise
+static int minimal_polynomials_known(algebraic_expr e) {
+	if (e.op == EXPR_LEAF)
+		return e.leaf->minimal_polynomial != NULL;
+	if ((e.right != NULL) && !minimal_polynomials_known(*(e.right)))
+		return 0;
+	
+	return minimal_polynomials_known(*(e.left));
+}
+
+static composed_expr *alloc_composed_expr(composed_op op, composed_expr *left, composed_expr *right) {
+	composed_expr *result = (composed_expr*) malloc(sizeof(composed_expr));
+	result->op = op;
+	result->leaf = NULL;
+	result->left = left;
+	result->right = right;
+	
+	return result;
+}
+
+static void free_composed_expr(composed_expr *e) {
+	if (e->left != NULL)
+		free_composed_expr(e->left);
+	if (e->right != NULL)
+		free_composed_expr(e->right);
+	free(e);
+}
+
+// translates e into an expression over the minimal polynomials of its leaves, which must be known
+static composed_expr *to_composed_expr(algebraic_expr e) {
+	if (e.op == EXPR_LEAF) {
+		composed_expr *result = alloc_composed_expr(COMPOSED_LEAF, NULL, NULL);
+		result->leaf = e.leaf->minimal_polynomial;
+		return result;
+	}
+	composed_expr *left = to_composed_expr(*(e.left)), *right = NULL;
+	if (e.right != NULL)
+		right = to_composed_expr(*(e.right));
+	switch (e.op) {
+		case EXPR_ADD:
+			return alloc_composed_expr(COMPOSED_SUM, left, right);
+		case EXPR_SUBTRACT:	// a - b = a + (-b)
+			return alloc_composed_expr(COMPOSED_SUM, left, alloc_composed_expr(COMPOSED_NEGATE, right, NULL));
+		case EXPR_MULT:
+			return alloc_composed_expr(COMPOSED_PRODUCT, left, right);
+		case EXPR_DIVIDE:	// a / b = a * (1/b)
+			return alloc_composed_expr(COMPOSED_PRODUCT, left, alloc_composed_expr(COMPOSED_INVERT, right, NULL));
+		case EXPR_NEGATE:
+			return alloc_composed_expr(COMPOSED_NEGATE, left, NULL);
+		default:
+			return alloc_composed_expr(COMPOSED_INVERT, left, NULL);
+	}
+}
+
+// evaluates an arithmetic expression over algebraic numbers
+// the polynomial with every combination of the conjugates of the leaves as zeros is computed in one pass,
+// without the intermediate polynomials, so a factor only has to be picked once at the end
+// if the coefficients are too large, falls back to evaluating one operation at a time
+algebraic *algebraic_eval_expr(algebraic_expr e) {
+	algebraic *result = eval_expr_stepwise(e, 1);
+	if (!minimal_polynomials_known(e))
+		return result;
+	composed_expr *min_poly_expr = to_composed_expr(e);
+	polynomial *min_poly_unfactored = composed_polynomial(*min_poly_expr, NULL);
+	free_composed_expr(min_poly_expr);
+	if (min_poly_unfactored == NULL) {
+		free_algebraic(result);
+		return eval_expr_stepwise(e, 0);
+	}
+	set_minimal_polynomial(result, find_factor(*min_poly_unfactored, result->approx_val));
+	free_polynomial(min_poly_unfactored);
+	
+	return result;
+}
+
 /* ---------- Number-Theoretic Functions ---------- */
 
 static complex_root_list *get_galois_conjugates(algebraic a) {
@@ -293,10 +487,15 @@ void print_all_information(algebraic a) {
  * Minimal polynomial: x^10 - 10x^8 + 38x^6 + 2x^5 - 100x^4 + 40x^3 + 121x^2 + 38x^1 - 17
  * mult_algebraics:
  * Approximate value: 1.650817, Error: 0.000000
- * Minimal polynomial: 2107536x^10 - 1022x^9 + 24532x^8 - 337314x^7 - 13927955x^6 - 16764517x^5 + 63502981x^4 - 156288926x^3 + 270743008x^2 - 197531212x^1
+ * Minimal polynomial: x^10 - 8x^6 + 16x^2 - 32
  * divide_algebraics:
  * Approximate value: 0.825409, Error: 0.000000
- * Minimal polynomial: -1251375499x^10 + 593x^9 - 14225x^8 + 195592x^7 + 623987515x^6 + 9720926x^5 - 36822283x^4 + 90624330x^3 - 215648899x^2 + 114538721x^1
+ * Minimal polynomial: 32x^10 - 16x^6 + 2x^2 - 1
+ * algebraic_eval_expr:
+ * Approximate value: 0.585786, Error: 0.000000
+ * Minimal polynomial: x^2 - 4x^1 + 2
+ * algebraic_eval_expr: 1
+ * irreducibility: 1, 1, 1
  * print_galois_conjugates:
  * Galois conjugates:
  * Root 0: Approximate value: -1.414214, Error: 0.000000
@@ -324,6 +523,21 @@ void test_algebraics_functions() {
 	print_algebraic(*mult_algebraics(*a,*b));
 	printf("divide_algebraics:\n");
 	print_algebraic(*divide_algebraics(*a,*b));
+	printf("algebraic_eval_expr:\n");
+	algebraic_expr *chained = binary_expr(EXPR_ADD, binary_expr(EXPR_MULT, leaf_expr(b), leaf_expr(b)), leaf_expr(b));
+	print_algebraic(*algebraic_eval_expr(*chained));
+	free_algebraic_expr(chained);
+	// a single operation should agree with the corresponding function
+	algebraic_expr *quotient = binary_expr(EXPR_DIVIDE, leaf_expr(a), leaf_expr(b));
+	polynomial *fused = algebraic_eval_expr(*quotient)->minimal_polynomial;
+	polynomial *stepwise = divide_algebraics(*a, *b)->minimal_polynomial;
+	int agree = (fused->deg == stepwise->deg);
+	for (int i=0; agree && (i<=fused->deg); i++)
+		agree = (fused->coefficients[i] == stepwise->coefficients[i]);
+	printf("algebraic_eval_expr: %d\n", agree);
+	free_algebraic_expr(quotient);
+	// the degrees 5 and 2 are coprime, so the sum is irreducible without factoring
+	printf("irreducibility: %d, %d, %d\n", a->irreducible, b->irreducible, add_algebraics(*a, *b)->irreducible);
 	printf("print_galois_conjugates:\n");
 	print_galois_conjugates(*b);
 	printf("read_algebraic:\n");
@@ -5,12 +5,31 @@
 
 #include "roots.h"
 #include "precision.h"
+#include "factoring.h"
 
 typedef struct algebraic {
 	ball approx_val;
 	polynomial *minimal_polynomial;	// a NULL pointer indicates that the minimal polynomial is not known
+	irreducibility irreducible;		// whether minimal_polynomial is known to be irreducible, which arithmetic uses to skip factoring
 } algebraic;
 
+typedef enum expr_op {
+	EXPR_LEAF,
+	EXPR_ADD,
+	EXPR_SUBTRACT,
+	EXPR_MULT,
+	EXPR_DIVIDE,
+	EXPR_NEGATE,
+	EXPR_INVERT
+} expr_op;
+
+// an arithmetic expression over algebraic numbers
+typedef struct algebraic_expr {
+	expr_op op;
+	algebraic *leaf;						// only used by EXPR_LEAF, and not owned by the expression
+	struct algebraic_expr *left, *right;	// right is unused by EXPR_NEGATE and EXPR_INVERT
+} algebraic_expr;
+
 void free_algebraic(algebraic *);
 
 algebraic *copy_algebraic(algebraic);
@@ -33,6 +52,16 @@ algebraic *invert_algebraic(algebraic);
 
 algebraic *divide_algebraics(algebraic, algebraic);
 
+algebraic_expr *leaf_expr(algebraic *);
+
+algebraic_expr *unary_expr(expr_op, algebraic_expr *);
+
+algebraic_expr *binary_expr(expr_op, algebraic_expr *, algebraic_expr *);
+
+void free_algebraic_expr(algebraic_expr *);
+
+algebraic *algebraic_eval_expr(algebraic_expr);
+
 algebraic *read_algebraic();
 
 void print_algebraic(algebraic);
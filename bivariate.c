@@ -0,0 +1,689 @@
+// bivariate.c
+// implements polynomials in Z[x][y] and their resultants with respect to y
+// this allows relations between algebraic numbers to be eliminated directly, without evaluating and interpolating
+
+#include "bivariate.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <limits.h>
+
+static int is_zero_polynomial(polynomial p) {
+	return (p.deg == 0) && (p.coefficients[0] == 0);
+}
+
+static int is_zero_bivariate(bivariate a) {
+	return (a.deg == 0) && is_zero_polynomial(*a.coefficients[0]);
+}
+
+/* ---------- Memory Functions ---------- */
+
+// allocates a bivariate polynomial of degree deg in y on the heap with all coefficients 0
+bivariate *alloc_bivariate(int deg) {
+	bivariate *result = (bivariate*) malloc(sizeof(bivariate));
+	result->deg = deg;
+	result->coefficients = (polynomial**) malloc(sizeof(polynomial*) * (deg + 1));
+	for (int i=0; i<=deg; i++) {
+		result->coefficients[i] = int_to_polynomial(0);
+	}
+
+	return result;
+}
+
+bivariate *copy_bivariate(bivariate a) {
+	bivariate *result = (bivariate*) malloc(sizeof(bivariate));
+	result->deg = a.deg;
+	result->coefficients = (polynomial**) malloc(sizeof(polynomial*) * (a.deg + 1));
+	for (int i=0; i<=a.deg; i++) {
+		result->coefficients[i] = copy_polynomial(*a.coefficients[i]);
+	}
+
+	return result;
+}
+
+void free_bivariate(bivariate *a) {
+	for (int i=0; i<=a->deg; i++) {
+		free_polynomial(a->coefficients[i]);
+	}
+	free(a->coefficients);
+	free(a);
+}
+
+// strips leading zero coefficients, so that the degree in y is correct
+void strip_bivariate_zeros(bivariate *a) {
+	int num_leading_zeros = 0;
+	while ((num_leading_zeros < a->deg) && is_zero_polynomial(*a->coefficients[num_leading_zeros])) {
+		free_polynomial(a->coefficients[num_leading_zeros]);
+		num_leading_zeros++;
+	}
+	if (num_leading_zeros == 0)
+		return;
+	for (int i=0; i<=a->deg-num_leading_zeros; i++) {
+		a->coefficients[i] = a->coefficients[i + num_leading_zeros];
+	}
+	a->deg -= num_leading_zeros;
+}
+
+/* ---------- Lifting ---------- */
+
+// returns p(x) as a bivariate polynomial of degree 0 in y
+bivariate *polynomial_in_x(polynomial p) {
+	bivariate *result = alloc_bivariate(0);
+	free_polynomial(result->coefficients[0]);
+	result->coefficients[0] = copy_polynomial(p);
+
+	return result;
+}
+
+// returns p(y), whose coefficients are constants in x
+bivariate *polynomial_in_y(polynomial p) {
+	bivariate *result = alloc_bivariate(p.deg);
+	for (int i=0; i<=p.deg; i++) {
+		result->coefficients[i]->coefficients[0] = p.coefficients[i];
+	}
+
+	return result;
+}
+
+// returns q(x - y), using horner's scheme
+// returns NULL if a coefficient does not fit in an int
+bivariate *sum_substitution(polynomial q) {
+	bivariate *x_minus_y = alloc_bivariate(1);
+	x_minus_y->coefficients[0]->coefficients[0] = -1;
+	free_polynomial(x_minus_y->coefficients[1]);
+	x_minus_y->coefficients[1] = alloc_polynomial(1);
+	x_minus_y->coefficients[1]->coefficients[0] = 1;
+	x_minus_y->coefficients[1]->coefficients[1] = 0;
+
+	bivariate *result = alloc_bivariate(0);
+	for (int i=0; i<=q.deg; i++) {
+		bivariate *temp_result = mult_bivariate(*result, *x_minus_y);
+		free_bivariate(result);
+		result = temp_result;
+		if (result == NULL)
+			break;
+		polynomial *constant_term = result->coefficients[result->deg];
+		int *coeff = &constant_term->coefficients[constant_term->deg];
+		if (__builtin_add_overflow(*coeff, q.coefficients[i], coeff)) {
+			free_bivariate(result);
+			result = NULL;
+			break;
+		}
+	}
+	free_bivariate(x_minus_y);
+
+	return result;
+}
+
+// returns y^q.deg * q(x / y)
+// the coefficient of y^k is the coefficient of z^k in q(z) times x^(q.deg-k)
+bivariate *product_substitution(polynomial q) {
+	bivariate *result = alloc_bivariate(q.deg);
+	for (int i=0; i<=q.deg; i++) {
+		free_polynomial(result->coefficients[i]);
+		result->coefficients[i] = calloc_polynomial(i);
+		result->coefficients[i]->coefficients[0] = q.coefficients[q.deg - i];
+		strip_leading_zeros(result->coefficients[i]);
+	}
+	strip_bivariate_zeros(result);
+
+	return result;
+}
+
+/* ---------- Arithmetic ---------- */
+
+bivariate *add_bivariate(bivariate a, bivariate b) {
+	if (a.deg < b.deg)
+		return add_bivariate(b, a);
+	bivariate *result = copy_bivariate(a);
+	for (int i=a.deg-b.deg; i<=a.deg; i++) {
+		polynomial *sum = add_polynomials(*result->coefficients[i], *b.coefficients[i - a.deg + b.deg]);
+		free_polynomial(result->coefficients[i]);
+		result->coefficients[i] = sum;
+	}
+	strip_bivariate_zeros(result);
+
+	return result;
+}
+
+bivariate *subtract_bivariate(bivariate a, bivariate b) {
+	bivariate *b_neg = copy_bivariate(b);
+	for (int i=0; i<=b.deg; i++) {
+		polynomial *negated = negate_polynomial(*b_neg->coefficients[i]);
+		free_polynomial(b_neg->coefficients[i]);
+		b_neg->coefficients[i] = negated;
+	}
+	bivariate *result = add_bivariate(a, *b_neg);
+	free_bivariate(b_neg);
+
+	return result;
+}
+
+/* ---------- Wide Coefficients ---------- */
+// the subresultant sequence passes through coefficients far larger than those of the resultant,
+// so products and resultants are computed with 128-bit coefficients, and every operation is checked for overflow
+
+// a polynomial in x with 128-bit coefficients
+typedef struct wide_polynomial {
+	int deg;
+	__int128 *coefficients;	// from highest to lowest degree, as in polynomial
+} wide_polynomial;
+
+// a polynomial in y whose coefficients are wide polynomials in x
+typedef struct wide_bivariate {
+	int deg;
+	wide_polynomial **coefficients;	// from highest to lowest degree in y
+} wide_bivariate;
+
+// allocates a wide polynomial of degree deg with all coefficients 0
+static wide_polynomial *alloc_wide(int deg) {
+	wide_polynomial *result = (wide_polynomial*) malloc(sizeof(wide_polynomial));
+	result->deg = deg;
+	result->coefficients = (__int128*) calloc(deg + 1, sizeof(__int128));
+
+	return result;
+}
+
+static void free_wide(wide_polynomial *p) {
+	if (p == NULL)
+		return;
+	free(p->coefficients);
+	free(p);
+}
+
+static wide_polynomial *copy_wide(wide_polynomial p) {
+	wide_polynomial *result = alloc_wide(p.deg);
+	for (int i=0; i<=p.deg; i++) {
+		result->coefficients[i] = p.coefficients[i];
+	}
+
+	return result;
+}
+
+static wide_polynomial *to_wide(polynomial p) {
+	wide_polynomial *result = alloc_wide(p.deg);
+	for (int i=0; i<=p.deg; i++) {
+		result->coefficients[i] = p.coefficients[i];
+	}
+
+	return result;
+}
+
+// returns p as a polynomial, or NULL if a coefficient does not fit in an int
+static polynomial *from_wide(wide_polynomial p) {
+	polynomial *result = alloc_polynomial(p.deg);
+	for (int i=0; i<=p.deg; i++) {
+		if ((p.coefficients[i] > INT_MAX) || (p.coefficients[i] < INT_MIN)) {
+			free_polynomial(result);
+			return NULL;
+		}
+		result->coefficients[i] = (int) p.coefficients[i];
+	}
+
+	return result;
+}
+
+static int is_zero_wide(wide_polynomial p) {
+	return (p.deg == 0) && (p.coefficients[0] == 0);
+}
+
+static void strip_wide(wide_polynomial *p) {
+	int num_leading_zeros = 0;
+	while ((num_leading_zeros < p->deg) && (p->coefficients[num_leading_zeros] == 0))
+		num_leading_zeros++;
+	if (num_leading_zeros == 0)
+		return;
+	for (int i=0; i<=p->deg-num_leading_zeros; i++) {
+		p->coefficients[i] = p->coefficients[i + num_leading_zeros];
+	}
+	p->deg -= num_leading_zeros;
+}
+
+// returns p * q, or NULL on overflow
+static wide_polynomial *mult_wide(wide_polynomial p, wide_polynomial q) {
+	wide_polynomial *result = alloc_wide(p.deg + q.deg);
+	for (int i=0; i<=p.deg; i++) {
+		if (p.coefficients[i] == 0)
+			continue;
+		for (int j=0; j<=q.deg; j++) {
+			__int128 term;
+			if (__builtin_mul_overflow(p.coefficients[i], q.coefficients[j], &term)
+					|| __builtin_add_overflow(result->coefficients[i + j], term, &result->coefficients[i + j])) {
+				free_wide(result);
+				return NULL;
+			}
+		}
+	}
+	strip_wide(result);
+
+	return result;
+}
+
+// returns p - q, or NULL on overflow
+static wide_polynomial *subtract_wide(wide_polynomial p, wide_polynomial q) {
+	int deg = (p.deg > q.deg) ? p.deg : q.deg;
+	wide_polynomial *result = alloc_wide(deg);
+	for (int i=0; i<=p.deg; i++) {
+		result->coefficients[deg - p.deg + i] = p.coefficients[i];
+	}
+	for (int i=0; i<=q.deg; i++) {
+		__int128 *coeff = &result->coefficients[deg - q.deg + i];
+		if (__builtin_sub_overflow(*coeff, q.coefficients[i], coeff)) {
+			free_wide(result);
+			return NULL;
+		}
+	}
+	strip_wide(result);
+
+	return result;
+}
+
+// returns p^n, or NULL on overflow
+static wide_polynomial *power_wide(wide_polynomial p, int n) {
+	wide_polynomial *result = alloc_wide(0);
+	result->coefficients[0] = 1;
+	for (int i=0; (i<n) && (result != NULL); i++) {
+		wide_polynomial *temp = mult_wide(*result, p);
+		free_wide(result);
+		result = temp;
+	}
+
+	return result;
+}
+
+// returns p / q if q divides p exactly, and NULL otherwise or on overflow
+static wide_polynomial *divide_wide(wide_polynomial p, wide_polynomial q) {
+	assert(q.coefficients[0] != 0);	// cannot divide by 0
+	if (is_zero_wide(p))
+		return alloc_wide(0);
+	if (p.deg < q.deg)
+		return NULL;
+	wide_polynomial *remainder = copy_wide(p);
+	wide_polynomial *result = alloc_wide(p.deg - q.deg);
+	int exact = 1;
+	for (int i=0; (i<=result->deg) && exact; i++) {
+		exact = (remainder->coefficients[i] % q.coefficients[0] == 0);
+		result->coefficients[i] = remainder->coefficients[i] / q.coefficients[0];
+		for (int j=0; (j<=q.deg) && exact; j++) {
+			__int128 term;
+			exact = !__builtin_mul_overflow(result->coefficients[i], q.coefficients[j], &term)
+					&& !__builtin_sub_overflow(remainder->coefficients[i + j], term, &remainder->coefficients[i + j]);
+		}
+	}
+	for (int i=result->deg+1; (i<=p.deg) && exact; i++) {
+		exact = (remainder->coefficients[i] == 0);
+	}
+	free_wide(remainder);
+	if (!exact) {
+		free_wide(result);
+		return NULL;
+	}
+
+	return result;
+}
+
+static wide_bivariate *alloc_wide_bivariate(int deg) {
+	wide_bivariate *result = (wide_bivariate*) malloc(sizeof(wide_bivariate));
+	result->deg = deg;
+	result->coefficients = (wide_polynomial**) calloc(deg + 1, sizeof(wide_polynomial*));
+
+	return result;
+}
+
+// frees a, including any coefficients which have been set
+static void free_wide_bivariate(wide_bivariate *a) {
+	if (a == NULL)
+		return;
+	for (int i=0; i<=a->deg; i++) {
+		free_wide(a->coefficients[i]);
+	}
+	free(a->coefficients);
+	free(a);
+}
+
+static wide_bivariate *to_wide_bivariate(bivariate a) {
+	wide_bivariate *result = alloc_wide_bivariate(a.deg);
+	for (int i=0; i<=a.deg; i++) {
+		result->coefficients[i] = to_wide(*a.coefficients[i]);
+	}
+
+	return result;
+}
+
+static int is_zero_wide_bivariate(wide_bivariate a) {
+	return (a.deg == 0) && is_zero_wide(*a.coefficients[0]);
+}
+
+// strips leading zero coefficients, so that the degree in y is correct
+static void strip_wide_bivariate(wide_bivariate *a) {
+	int num_leading_zeros = 0;
+	while ((num_leading_zeros < a->deg) && is_zero_wide(*a->coefficients[num_leading_zeros])) {
+		free_wide(a->coefficients[num_leading_zeros]);
+		num_leading_zeros++;
+	}
+	if (num_leading_zeros == 0)
+		return;
+	for (int i=0; i<=a->deg-num_leading_zeros; i++) {
+		a->coefficients[i] = a->coefficients[i + num_leading_zeros];
+	}
+	a->deg -= num_leading_zeros;
+}
+
+// returns a / c, for c a polynomial in x, or NULL if c does not divide every coefficient of a or on overflow
+static wide_bivariate *divide_wide_bivariate(wide_bivariate a, wide_polynomial c) {
+	wide_bivariate *result = alloc_wide_bivariate(a.deg);
+	for (int i=0; i<=a.deg; i++) {
+		result->coefficients[i] = divide_wide(*a.coefficients[i], c);
+		if (result->coefficients[i] == NULL) {
+			free_wide_bivariate(result);
+			return NULL;
+		}
+	}
+
+	return result;
+}
+
+/* ---------- Products ---------- */
+
+// returns the largest degree in x of the coefficients of a
+static int x_degree(bivariate a) {
+	int result = 0;
+	for (int i=0; i<=a.deg; i++) {
+		if (a.coefficients[i]->deg > result)
+			result = a.coefficients[i]->deg;
+	}
+
+	return result;
+}
+
+// packs a into a univariate polynomial by the kronecker substitution x = t, y = t^block
+// block must exceed the degree in x of a, so that no two terms land on the same power of t
+static wide_polynomial *kronecker_pack(bivariate a, int block) {
+	wide_polynomial *result = alloc_wide(a.deg * block + x_degree(a));
+	for (int i=0; i<=a.deg; i++) {
+		polynomial coeff = *a.coefficients[i];
+		for (int j=0; j<=coeff.deg; j++) {
+			// x^(coeff.deg-j) * y^(a.deg-i) goes to t^((a.deg-i)*block + coeff.deg-j)
+			int exponent = (a.deg - i) * block + coeff.deg - j;
+			result->coefficients[result->deg - exponent] = coeff.coefficients[j];
+		}
+	}
+
+	return result;
+}
+
+// inverts kronecker_pack, given that the result has degree at most deg in y
+// returns NULL if a coefficient does not fit in an int
+static bivariate *kronecker_unpack(wide_polynomial packed, int deg, int block) {
+	bivariate *result = alloc_bivariate(deg);
+	for (int i=0; i<=deg; i++) {
+		free_polynomial(result->coefficients[i]);
+		result->coefficients[i] = calloc_polynomial(block - 1);
+	}
+	for (int exponent=0; exponent<=packed.deg; exponent++) {
+		__int128 value = packed.coefficients[packed.deg - exponent];
+		if ((value > INT_MAX) || (value < INT_MIN)) {
+			free_bivariate(result);
+			return NULL;
+		}
+		polynomial *coeff = result->coefficients[deg - exponent / block];
+		coeff->coefficients[coeff->deg - exponent % block] = (int) value;
+	}
+	for (int i=0; i<=deg; i++) {
+		strip_leading_zeros(result->coefficients[i]);
+	}
+	strip_bivariate_zeros(result);
+
+	return result;
+}
+
+// multiplies a and b with a single univariate multiplication, using the kronecker substitution
+// returns NULL if a coefficient of the product does not fit in an int
+bivariate *mult_bivariate(bivariate a, bivariate b) {
+	int block = x_degree(a) + x_degree(b) + 1;	// the degree in x of the product is less than block
+	wide_polynomial *a_packed = kronecker_pack(a, block);
+	wide_polynomial *b_packed = kronecker_pack(b, block);
+	wide_polynomial *product = mult_wide(*a_packed, *b_packed);
+	bivariate *result = (product != NULL) ? kronecker_unpack(*product, a.deg + b.deg, block) : NULL;
+	free_wide(a_packed);
+	free_wide(b_packed);
+	free_wide(product);
+
+	return result;
+}
+
+/* ---------- Resultants ---------- */
+
+// returns lc(b)^(a.deg-b.deg+1) * a mod b, where the leading coefficient and remainder are taken in y
+// this is a multiple of the true remainder which has coefficients in Z[x]
+// returns NULL on overflow
+static wide_bivariate *pseudo_remainder(wide_bivariate a, wide_bivariate b) {
+	assert(b.deg > 0);
+	wide_bivariate *result = alloc_wide_bivariate(a.deg);
+	for (int i=0; i<=a.deg; i++) {
+		result->coefficients[i] = copy_wide(*a.coefficients[i]);
+	}
+	int remaining_steps = a.deg - b.deg + 1;
+	while ((result != NULL) && !is_zero_wide_bivariate(*result) && (result->deg >= b.deg)) {
+		// cancel the leading term, result = lc(b)*result - lc(result)*y^(result.deg-b.deg)*b
+		wide_bivariate *next = alloc_wide_bivariate(result->deg);
+		int success = 1;
+		for (int i=0; (i<=result->deg) && success; i++) {
+			next->coefficients[i] = mult_wide(*b.coefficients[0], *result->coefficients[i]);
+			if ((i <= b.deg) && (next->coefficients[i] != NULL)) {
+				wide_polynomial *cancelled = mult_wide(*result->coefficients[0], *b.coefficients[i]);
+				wide_polynomial *difference = (cancelled != NULL) ? subtract_wide(*next->coefficients[i], *cancelled) : NULL;
+				free_wide(next->coefficients[i]);
+				free_wide(cancelled);
+				next->coefficients[i] = difference;
+			}
+			success = (next->coefficients[i] != NULL);
+		}
+		free_wide_bivariate(result);
+		result = NULL;
+		if (success) {
+			result = next;
+			strip_wide_bivariate(result);
+		} else {
+			free_wide_bivariate(next);
+		}
+		remaining_steps--;
+	}
+	// the degree may have dropped by more than one in a step, in which case lc(b) is still owed
+	if ((result != NULL) && (remaining_steps > 0)) {
+		wide_polynomial *lc_power = power_wide(*b.coefficients[0], remaining_steps);
+		for (int i=0; (i<=result->deg) && (lc_power != NULL) && (result != NULL); i++) {
+			wide_polynomial *scaled = mult_wide(*result->coefficients[i], *lc_power);
+			if (scaled == NULL) {
+				free_wide_bivariate(result);
+				result = NULL;
+			} else {
+				free_wide(result->coefficients[i]);
+				result->coefficients[i] = scaled;
+			}
+		}
+		if (lc_power == NULL) {
+			free_wide_bivariate(result);
+			result = NULL;
+		}
+		free_wide(lc_power);
+	}
+
+	return result;
+}
+
+// computes res_y(a, b) as a polynomial in x using the subresultant polynomial remainder sequence
+// (cohen, a course in computational algebraic number theory, algorithm 3.3.7)
+// every division in the sequence is exact, and the sequence is run with checked 128-bit coefficients
+// returns NULL if an intermediate coefficient overflows, or a coefficient of the resultant does not fit in an int
+polynomial *resultant_y(bivariate a, bivariate b) {
+	if (is_zero_bivariate(a) || is_zero_bivariate(b))
+		return int_to_polynomial(0);
+	// res(a, b) = (-1)^(a.deg*b.deg) res(b, a)
+	int sign = 1;
+	if (a.deg < b.deg) {
+		bivariate temp = a;
+		a = b;
+		b = temp;
+		if ((a.deg % 2 == 1) && (b.deg % 2 == 1))
+			sign = -1;
+	}
+	wide_bivariate *a_cur = to_wide_bivariate(a), *b_cur = to_wide_bivariate(b);
+	wide_polynomial *g = alloc_wide(0), *h = alloc_wide(0);
+	g->coefficients[0] = 1;
+	h->coefficients[0] = 1;
+	int common_factor = 0;
+	while ((b_cur != NULL) && (h != NULL) && (b_cur->deg > 0)) {
+		int delta = a_cur->deg - b_cur->deg;
+		if ((a_cur->deg % 2 == 1) && (b_cur->deg % 2 == 1))
+			sign = -sign;
+		wide_bivariate *remainder = pseudo_remainder(*a_cur, *b_cur);
+		if ((remainder != NULL) && is_zero_wide_bivariate(*remainder)) {	// a and b have a common factor
+			common_factor = 1;
+			free_wide_bivariate(remainder);
+			break;
+		}
+		// a, b = b, remainder / (g*h^delta)
+		wide_polynomial *h_power = power_wide(*h, delta);
+		wide_polynomial *divisor = (h_power != NULL) ? mult_wide(*g, *h_power) : NULL;
+		free_wide_bivariate(a_cur);
+		a_cur = b_cur;
+		b_cur = ((remainder != NULL) && (divisor != NULL)) ? divide_wide_bivariate(*remainder, *divisor) : NULL;
+		free_wide_bivariate(remainder);
+		free_wide(h_power);
+		free_wide(divisor);
+		// g = lc(a), h = g^delta / h^(delta-1)
+		free_wide(g);
+		g = copy_wide(*a_cur->coefficients[0]);
+		if (delta > 0) {
+			wide_polynomial *g_power = power_wide(*g, delta);
+			h_power = power_wide(*h, delta - 1);
+			free_wide(h);
+			h = ((g_power != NULL) && (h_power != NULL)) ? divide_wide(*g_power, *h_power) : NULL;
+			free_wide(g_power);
+			free_wide(h_power);
+		}
+	}
+	polynomial *result = NULL;
+	if (common_factor) {
+		result = int_to_polynomial(0);
+	} else if ((b_cur != NULL) && (h != NULL)) {
+		// b is now constant in y, and the resultant is lc(b)^a.deg / h^(a.deg-1)
+		wide_polynomial *lc_power = power_wide(*b_cur->coefficients[0], a_cur->deg);
+		wide_polynomial *h_power = power_wide(*h, a_cur->deg - 1);
+		wide_polynomial *quotient = ((lc_power != NULL) && (h_power != NULL)) ? divide_wide(*lc_power, *h_power) : NULL;
+		if (quotient != NULL) {
+			for (int i=0; i<=quotient->deg; i++) {
+				quotient->coefficients[i] *= sign;
+			}
+			result = from_wide(*quotient);
+		}
+		free_wide(lc_power);
+		free_wide(h_power);
+		free_wide(quotient);
+	}
+	free_wide(g);
+	free_wide(h);
+	free_wide_bivariate(a_cur);
+	free_wide_bivariate(b_cur);
+
+	return result;
+}
+
+/* ---------- Output ---------- */
+
+// prints the coefficient of each power of y on its own line
+void print_bivariate(bivariate a) {
+	for (int i=0; i<=a.deg; i++) {
+		printf("y^%d: ", a.deg - i);
+		print_polynomial(*a.coefficients[i]);
+	}
+}
+
+/* ---------- Testing ---------- */
+// to test, run "make test bivariate"
+
+#ifdef TEST_BIVARIATE
+#include "resultant.h"
+
+static int polynomials_equal(polynomial a, polynomial b) {
+	if (a.deg != b.deg)
+		return 0;
+	for (int i=0; i<=a.deg; i++) {
+		if (a.coefficients[i] != b.coefficients[i])
+			return 0;
+	}
+
+	return 1;
+}
+
+/* should output:
+ * mult_bivariate:
+ * y^2: -1
+ * y^1: 0
+ * y^0: x^2 - 1
+ * resultant_y: x^4 - 10x^2 + 1
+ * resultant_y: -2x^2 + 9
+ * resultant_sum: 1
+ * resultant_product: 1
+ * resultant_sum (degree 5 and 4): 1
+ * resultant_y overflow: 1 */
+void test_bivariate_functions() {
+	polynomial *one = int_to_polynomial(1);
+	polynomial *x = calloc_polynomial(1);
+	x->coefficients[0] = 1;
+	// (x - y)(x + y) - 1
+	bivariate *x_minus_y = sum_substitution(*x);
+	bivariate *x_plus_y = add_bivariate(*polynomial_in_x(*x), *polynomial_in_y(*x));
+	printf("mult_bivariate:\n");
+	print_bivariate(*subtract_bivariate(*mult_bivariate(*x_minus_y, *x_plus_y), *polynomial_in_x(*one)));
+	// eliminating y from y^2 = 2 and (x - y)^2 = 3 gives the minimal polynomial of sqrt(2) + sqrt(3)
+	polynomial *p = calloc_polynomial(2);
+	p->coefficients[0] = 1;
+	p->coefficients[2] = -2;
+	polynomial *q = calloc_polynomial(2);
+	q->coefficients[0] = 1;
+	q->coefficients[2] = -3;
+	bivariate *p_lifted = polynomial_in_y(*p);
+	printf("resultant_y: ");
+	print_polynomial(*resultant_y(*p_lifted, *sum_substitution(*q)));
+	// eliminating y from y^2 = 2 and x*y = y^2 + 1 gives the minimal polynomial of sqrt(2) + 1/sqrt(2)
+	bivariate *xy = alloc_bivariate(1);
+	free_polynomial(xy->coefficients[0]);
+	xy->coefficients[0] = copy_polynomial(*x);
+	bivariate *y_sq_plus_1 = add_bivariate(*p_lifted, *polynomial_in_x(*int_to_polynomial(3)));
+	printf("resultant_y: ");
+	print_polynomial(*resultant_y(*p_lifted, *subtract_bivariate(*xy, *y_sq_plus_1)));
+	// the subresultant sequence should agree with the sum and product kernels
+	polynomial *f = calloc_polynomial(5);
+	f->coefficients[0] = 1;
+	f->coefficients[4] = -1;
+	f->coefficients[5] = 1;
+	polynomial *g = alloc_polynomial(2);
+	g->coefficients[0] = 2;
+	g->coefficients[1] = 1;
+	g->coefficients[2] = -2;
+	bivariate *f_lifted = polynomial_in_y(*f);
+	printf("resultant_sum: %d\n", polynomials_equal(*resultant_y(*f_lifted, *sum_substitution(*g)), *resultant_sum(*f, *g)));
+	printf("resultant_product: %d\n",
+			polynomials_equal(*resultant_y(*f_lifted, *product_substitution(*g)), *resultant_product(*f, *g)));
+	// the sequence for x^5 - x + 1 and x^4 - 10x^2 + 1 passes through coefficients which do not fit in an int
+	polynomial *h = calloc_polynomial(4);
+	h->coefficients[0] = 1;
+	h->coefficients[2] = -10;
+	h->coefficients[4] = 1;
+	printf("resultant_sum (degree 5 and 4): %d\n",
+			polynomials_equal(*resultant_y(*f_lifted, *sum_substitution(*h)), *resultant_sum(*f, *h)));
+	// a resultant which does not fit in an int is reported as NULL
+	polynomial *big = calloc_polynomial(4);
+	big->coefficients[0] = 1;
+	big->coefficients[4] = -100000;
+	printf("resultant_y overflow: %d\n", resultant_y(*f_lifted, *polynomial_in_x(*big)) == NULL);
+}
+
+int main(int argc, char **argv) {
+	test_bivariate_functions();
+	exit(0);
+}
+
+#endif
@@ -0,0 +1,41 @@
+// bivariate.h
+
+#ifndef BIVARIATE_H
+#define BIVARIATE_H
+
+#include "polynomial.h"
+
+// a polynomial in Z[x][y], i.e. a polynomial in y whose coefficients are integer polynomials in x
+typedef struct bivariate {
+	int deg;					// degree in y
+	polynomial **coefficients;	// from highest to lowest degree in y
+								// coefficients[0] must be nonzero unless deg is 0
+} bivariate;
+
+bivariate *alloc_bivariate(int);
+
+bivariate *copy_bivariate(bivariate);
+
+void free_bivariate(bivariate*);
+
+void strip_bivariate_zeros(bivariate*);
+
+bivariate *polynomial_in_x(polynomial);
+
+bivariate *polynomial_in_y(polynomial);
+
+bivariate *sum_substitution(polynomial);
+
+bivariate *product_substitution(polynomial);
+
+bivariate *add_bivariate(bivariate, bivariate);
+
+bivariate *subtract_bivariate(bivariate, bivariate);
+
+bivariate *mult_bivariate(bivariate, bivariate);
+
+polynomial *resultant_y(bivariate, bivariate);
+
+void print_bivariate(bivariate);
+
+#endif
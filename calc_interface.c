@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include <string.h>
 
 /* ---------- Stack Functions ---------- */
 
@@ -20,9 +21,10 @@ static algebraic *pop(stack s) {
 	assert(s->value != NULL);	// assert that stack is not empty
 	algebraic *result = s->value;
 	if (s->next != NULL) {
-		s->value = s->next->value;
-		free(s->next);
-		s->next = s->next->next;	// hanging pointer
+		stack next = s->next;
+		s->value = next->value;
+		s->next = next->next;
+		free(next);
 	} else {
 		s->value = NULL;
 	}
@@ -30,6 +32,17 @@ static algebraic *pop(stack s) {
 	return result;
 }
 
+// returns the value at position ind of the stack, counting from 0 at the top, or NULL if there is none
+static algebraic *peek(stack s, int ind) {
+	for (int i=0; (i<ind) && (s != NULL); i++) {
+		s = s->next;
+	}
+	if ((s == NULL) || (s->next == NULL))
+		return NULL;
+
+	return s->value;
+}
+
 /* ---------- Operations ---------- */
 
 void print(stack s) {
@@ -110,6 +123,51 @@ void divide(stack s) {
 	free_algebraic(b);
 }
 
+// reads an expression in postfix notation over positions on the stack, such as "0 1 + 2 *"
+// the whole expression is evaluated at once and its value is pushed, leaving the operands on the stack
+void evaluate(stack s) {
+	char input[256];
+	printf("Enter an expression in postfix notation, using + - * / neg inv and positions on the stack (0 is the top): ");
+	do {
+		fgets(input, 256, stdin);
+	} while (input[0] == '\n');
+	// parse the expression using a stack of subexpressions
+	algebraic_expr *operands[128];
+	int num_operands = 0, valid = 1;
+	for (char *token = strtok(input, " \n"); (token != NULL) && valid; token = strtok(NULL, " \n")) {
+		int ind;
+		expr_op op;
+		if (sscanf(token, "%d", &ind) == 1) {
+			algebraic *value = peek(s, ind);
+			valid = (value != NULL) && (num_operands < 128);
+			if (valid)
+				operands[num_operands++] = leaf_expr(value);
+			continue;
+		}
+		if (!strcmp(token, "neg") || !strcmp(token, "inv")) {
+			valid = (num_operands >= 1);
+			op = strcmp(token, "neg") ? EXPR_INVERT : EXPR_NEGATE;
+			if (valid)
+				operands[num_operands - 1] = unary_expr(op, operands[num_operands - 1]);
+			continue;
+		}
+		valid = (num_operands >= 2) && (strlen(token) == 1) && (strchr("+-*/", token[0]) != NULL);
+		if (valid) {
+			op = (token[0] == '+') ? EXPR_ADD : (token[0] == '-') ? EXPR_SUBTRACT : (token[0] == '*') ? EXPR_MULT : EXPR_DIVIDE;
+			operands[num_operands - 2] = binary_expr(op, operands[num_operands - 2], operands[num_operands - 1]);
+			num_operands--;
+		}
+	}
+	if (valid && (num_operands == 1)) {
+		push(algebraic_eval_expr(*operands[0]), s);
+	} else {
+		printf("Invalid expression.\n");
+	}
+	for (int i=0; i<num_operands; i++) {
+		free_algebraic_expr(operands[i]);
+	}
+}
+
 void clear(stack s) {
 	if (s->next != NULL) {
 		algebraic *a = pop(s);
@@ -136,6 +194,7 @@ void help() {
 			"multiply - multiplies the two values on top of the stack\n"
 			"invert - inverts the value on top of the stack\n"
 			"divide - divides the two values on top of the stack\n"
+			"evaluate - evaluates an expression over values on the stack in one step, e.g. \"0 1 + 2 *\"\n"
 			"clear - deletes the value on top of the stack\n"
 			"clear-all - deletes all values on the stack\n"
 			"quit - exits the program\n"
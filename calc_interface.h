@@ -30,6 +30,8 @@ void invert(stack);
 
 void divide(stack);
 
+void evaluate(stack);
+
 void clear(stack);
 
 void clear_all(stack);
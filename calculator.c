@@ -41,6 +41,8 @@ int main(int argc, char **argv) {
 			invert(s);
 		} else if (!strcmp(command, "divide\n")) {
 			divide(s);
+		} else if (!strcmp(command, "evaluate\n")) {
+			evaluate(s);
 		} else if (!strcmp(command, "clear\n")) {
 			clear(s);
 		} else if (!strcmp(command, "clear-all\n")) {
@@ -0,0 +1,464 @@
+// composed.c
+// computes polynomials whose zeros are obtained by combining the zeros of other polynomials
+// the zeros are never found: every polynomial is converted to the power sums of its zeros,
+// which are combined and converted back, all modulo several primes
+// a whole expression is evaluated this way, so intermediate polynomials are never reconstructed
+
+#include "composed.h"
+#include "modular.h"
+#include "integers.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <math.h>
+#include <limits.h>
+
+/* ---------- Newton's Identities ---------- */
+
+// fills in the power sums s_0,...,s_n of the zeros of the polynomial with coefficients c_0,...,c_deg mod m
+// uses c_0 s_k + c_1 s_(k-1) + ... + c_(k-1) s_1 + k c_k = 0, where c_i = 0 for i > deg
+// only the nonzero coefficients are visited, so sparse polynomials such as x^n - a are cheap
+// runtime: O(n * number of nonzero coefficients)
+static void power_sums(uint64_t *coeffs, int deg, int n, modulus m, uint64_t *sums) {
+	int *terms = (int*) malloc(sizeof(int) * (deg + 1));
+	int num_terms = 0;
+	for (int i=1; i<=deg; i++) {
+		if (coeffs[i] != 0)
+			terms[num_terms++] = i;
+	}
+	uint64_t lc_inv = mod_inverse(coeffs[0], m);
+	sums[0] = to_mod(deg, m);
+	for (int k=1; k<=n; k++) {
+		uint64_t total = (k <= deg) ? mod_mult(to_mod(k, m), coeffs[k], m) : 0;
+		for (int j=0; (j<num_terms) && (terms[j]<k); j++)
+			total = mod_add(total, mod_mult(coeffs[terms[j]], sums[k - terms[j]], m), m);
+		sums[k] = mod_neg(mod_mult(total, lc_inv, m), m);
+	}
+	free(terms);
+}
+
+// fills in the coefficients, from highest to lowest degree, of the monic polynomial of degree n
+// whose zeros have power sums s_1,...,s_n mod m
+// uses k e_k = -(e_(k-1) s_1 + e_(k-2) s_2 + ... + e_0 s_k)
+// runtime: O(n^2)
+static void from_power_sums(uint64_t *sums, int n, modulus m, uint64_t *coeffs) {
+	coeffs[0] = to_mod(1, m);
+	for (int k=1; k<=n; k++) {
+		uint64_t total = 0;
+		for (int i=1; i<=k; i++)
+			total = mod_add(total, mod_mult(coeffs[k - i], sums[i], m), m);
+		coeffs[k] = mod_neg(mod_mult(total, mod_inverse(to_mod(k, m), m), m), m);
+	}
+}
+
+/* ---------- Combining Power Sums ---------- */
+
+// the kth power sum of the products a*b is the product of the kth power sums of the a's and b's
+static void product_power_sums(uint64_t *p_sums, uint64_t *q_sums, int n, modulus m, uint64_t *result) {
+	for (int k=0; k<=n; k++)
+		result[k] = mod_mult(p_sums[k], q_sums[k], m);
+}
+
+// the kth power sum of the sums a+b is the binomial convolution sum_i C(k, i) s_i(a) s_(k-i)(b)
+// which is computed as the product of the exponential generating functions sum_k s_k x^k / k!
+// the zeros of x^n - a have s_k = 0 unless n divides k, so only the nonzero terms of the sparser series are visited
+// runtime: O(n * number of nonzero power sums)
+static void sum_power_sums(uint64_t *p_sums, uint64_t *q_sums, int n, modulus m, uint64_t *result) {
+	uint64_t *factorials = (uint64_t*) malloc(sizeof(uint64_t) * (n + 1));
+	uint64_t *inv_factorials = (uint64_t*) malloc(sizeof(uint64_t) * (n + 1));
+	factorials[0] = to_mod(1, m);
+	for (int k=1; k<=n; k++)
+		factorials[k] = mod_mult(factorials[k - 1], to_mod(k, m), m);
+	inv_factorials[n] = mod_inverse(factorials[n], m);
+	for (int k=n; k>0; k--)
+		inv_factorials[k - 1] = mod_mult(inv_factorials[k], to_mod(k, m), m);
+	uint64_t *p_egf = (uint64_t*) malloc(sizeof(uint64_t) * (n + 1));
+	uint64_t *q_egf = (uint64_t*) malloc(sizeof(uint64_t) * (n + 1));
+	int p_nonzero = 0, q_nonzero = 0;
+	for (int k=0; k<=n; k++) {
+		p_egf[k] = mod_mult(p_sums[k], inv_factorials[k], m);
+		q_egf[k] = mod_mult(q_sums[k], inv_factorials[k], m);
+		p_nonzero += (p_egf[k] != 0);
+		q_nonzero += (q_egf[k] != 0);
+	}
+	// the convolution is symmetric, so let q be the sparser series
+	if (p_nonzero < q_nonzero) {
+		uint64_t *temp = p_egf;
+		p_egf = q_egf;
+		q_egf = temp;
+	}
+	int *terms = (int*) malloc(sizeof(int) * (n + 1));
+	int num_terms = 0;
+	for (int k=0; k<=n; k++) {
+		if (q_egf[k] != 0)
+			terms[num_terms++] = k;
+	}
+	for (int k=0; k<=n; k++) {
+		uint64_t total = 0;
+		for (int j=0; (j<num_terms) && (terms[j]<=k); j++)
+			total = mod_add(total, mod_mult(p_egf[k - terms[j]], q_egf[terms[j]], m), m);
+		result[k] = mod_mult(total, factorials[k], m);
+	}
+	free(factorials);
+	free(inv_factorials);
+	free(p_egf);
+	free(q_egf);
+	free(terms);
+}
+
+/* ---------- Coefficient Bounds ---------- */
+
+// returns log2 of the 2-norm of the coefficients of p, which bounds its mahler measure by landau's inequality
+static double log2_mahler_bound(polynomial p) {
+	double norm_sq = 0;
+	for (int i=0; i<=p.deg; i++)
+		norm_sq += (double) p.coefficients[i] * (double) p.coefficients[i];
+
+	return log2(norm_sq) / 2.0;
+}
+
+// returns log2 of C(n, n/2), which bounds every binomial coefficient C(n, k)
+static double log2_central_binomial(int n) {
+	return (lgamma(n + 1.0) - lgamma(n / 2 + 1.0) - lgamma(n - n / 2 + 1.0)) / log(2.0);
+}
+
+// returns the degree of the polynomial of e
+static int expr_degree(composed_expr e) {
+	switch (e.op) {
+		case COMPOSED_LEAF:
+			return e.leaf->deg;
+		case COMPOSED_SUM:
+		case COMPOSED_PRODUCT:
+			return expr_degree(*e.left) * expr_degree(*e.right);
+		default:
+			return expr_degree(*e.left);
+	}
+}
+
+// returns log2 of a bound on the mahler measure of the polynomial of e
+// a composed product has mahler measure at most M(p)^q.deg * M(q)^p.deg
+// and a composed sum at most 2^(p.deg*q.deg) times that, since max(1, |a+b|) <= 2*max(1, |a|)*max(1, |b|)
+// negating or inverting the zeros does not change the mahler measure
+static double expr_mahler_bits(composed_expr e) {
+	switch (e.op) {
+		case COMPOSED_LEAF:
+			return log2_mahler_bound(*e.leaf);
+		case COMPOSED_SUM:
+		case COMPOSED_PRODUCT: {
+			int left_deg = expr_degree(*e.left), right_deg = expr_degree(*e.right);
+			double result = right_deg * expr_mahler_bits(*e.left) + left_deg * expr_mahler_bits(*e.right);
+			if (e.op == COMPOSED_SUM)
+				result += left_deg * right_deg;
+			return result;
+		}
+		default:
+			return expr_mahler_bits(*e.left);
+	}
+}
+
+/* ---------- Evaluating Expressions ---------- */
+
+// the zeros of the polynomial of a subexpression, as power sums mod m
+typedef struct zero_sums {
+	int deg;
+	uint64_t lc;		// the leading coefficient of the integer polynomial, mod m
+	uint64_t *sums;		// s_0,...,s_n for the n of the whole expression
+} zero_sums;
+
+// computes the power sums s_0,...,s_n of the polynomial of e mod m
+// the polynomial of a sum or product is lc(p)^q.deg * lc(q)^p.deg times its monic part, as for the resultant
+// negation gives p(-x) and inversion gives the reverse of p, which requires p(0) != 0
+// returns 0 if some inverted polynomial has a zero constant term mod m
+// runtime: O(n^2) per node
+static int eval_expr_mod(composed_expr e, int n, modulus m, zero_sums *result) {
+	result->sums = (uint64_t*) malloc(sizeof(uint64_t) * (n + 1));
+	if (e.op == COMPOSED_LEAF) {
+		uint64_t *coeffs = (uint64_t*) malloc(sizeof(uint64_t) * (e.leaf->deg + 1));
+		for (int i=0; i<=e.leaf->deg; i++)
+			coeffs[i] = to_mod(e.leaf->coefficients[i], m);
+		result->deg = e.leaf->deg;
+		result->lc = coeffs[0];
+		power_sums(coeffs, result->deg, n, m, result->sums);
+		free(coeffs);
+		return 1;
+	}
+
+	zero_sums left, right;
+	if (!eval_expr_mod(*e.left, n, m, &left)) {
+		free(result->sums);
+		return 0;
+	}
+	int success = 1;
+	switch (e.op) {
+		case COMPOSED_SUM:
+		case COMPOSED_PRODUCT:
+			if (!eval_expr_mod(*e.right, n, m, &right)) {
+				success = 0;
+				break;
+			}
+			result->deg = left.deg * right.deg;
+			result->lc = mod_mult(mod_pow(left.lc, right.deg, m), mod_pow(right.lc, left.deg, m), m);
+			if (e.op == COMPOSED_SUM)
+				sum_power_sums(left.sums, right.sums, n, m, result->sums);
+			else
+				product_power_sums(left.sums, right.sums, n, m, result->sums);
+			free(right.sums);
+			break;
+		case COMPOSED_NEGATE:
+			// s_k(-a) = (-1)^k s_k(a), and the leading coefficient of p(-x) is (-1)^deg lc(p)
+			result->deg = left.deg;
+			result->lc = (left.deg % 2 == 0) ? left.lc : mod_neg(left.lc, m);
+			for (int k=0; k<=n; k++)
+				result->sums[k] = (k % 2 == 0) ? left.sums[k] : mod_neg(left.sums[k], m);
+			break;
+		case COMPOSED_INVERT: {
+			// recover p, whose reverse has the inverted zeros and leading coefficient p(0)
+			uint64_t *coeffs = (uint64_t*) malloc(sizeof(uint64_t) * (left.deg + 1));
+			from_power_sums(left.sums, left.deg, m, coeffs);
+			result->deg = left.deg;
+			result->lc = mod_mult(left.lc, coeffs[left.deg], m);
+			if (result->lc == 0) {
+				success = 0;
+			} else {
+				for (int i=0; i<left.deg-i; i++) {
+					uint64_t temp = coeffs[i];
+					coeffs[i] = coeffs[left.deg - i];
+					coeffs[left.deg - i] = temp;
+				}
+				power_sums(coeffs, left.deg, n, m, result->sums);
+			}
+			free(coeffs);
+			break;
+		}
+		default:
+			assert(0);	// leaves are handled above
+	}
+	free(left.sums);
+	if (!success)
+		free(result->sums);
+
+	return success;
+}
+
+// computes the polynomial of e, whose coefficients are found modulo enough primes to cover a bound
+// on their size and recovered by chinese remaindering
+// returns NULL if the coefficients could be too large to recover or do not fit in an int,
+// or if an inverted polynomial has a zero at 0, and sets *status to the reason if status is not NULL
+// runtime: O(n^2) per node of e and prime, where n is the degree of the result
+polynomial *composed_polynomial(composed_expr e, composed_status *status) {
+	composed_status ignored;
+	if (status == NULL)
+		status = &ignored;
+	*status = COMPOSED_OVERFLOW;
+	int n = expr_degree(e);
+	// every coefficient of a polynomial of degree n is bounded by C(n, n/2) times its mahler measure
+	// one extra bit covers rounding in the floating point estimate
+	double bound_bits = expr_mahler_bits(e) + log2_central_binomial(n) + 1.0;
+	if (bound_bits + 2.0 > NUM_MODULAR_PRIMES * MODULAR_PRIME_BITS)
+		return NULL;
+	int num_primes = primes_for_bits(bound_bits);
+	// the residues of the ith coefficient are stored in residues[i*num_primes],...,residues[i*num_primes + num_primes-1]
+	uint64_t *residues = (uint64_t*) malloc(sizeof(uint64_t) * num_primes * (n + 1));
+	uint64_t *coeffs = (uint64_t*) malloc(sizeof(uint64_t) * (n + 1));
+	int success = 1;
+	for (int k=0; (k<num_primes) && success; k++) {
+		modulus m = modular_prime(k);
+		zero_sums zeros;
+		success = eval_expr_mod(e, n, m, &zeros);
+		if (!success)
+			break;
+		from_power_sums(zeros.sums, n, m, coeffs);
+		for (int i=0; i<=n; i++)
+			residues[i * num_primes + k] = from_mod(mod_mult(zeros.lc, coeffs[i], m), m);
+		free(zeros.sums);
+	}
+	free(coeffs);
+	if (!success)
+		*status = COMPOSED_EVAL_FAILED;
+
+	polynomial *result = NULL;
+	if (success)
+		result = alloc_polynomial(n);
+	for (int i=0; (i<=n) && (result != NULL); i++) {
+		long long low_bits;
+		matrix_entry approx = crt_reconstruct(residues + i * num_primes, num_primes, &low_bits);
+		if ((approx > INT_MAX) || (approx < INT_MIN)) {
+			free_polynomial(result);
+			result = NULL;
+		} else {
+			result->coefficients[i] = (int) low_bits;
+		}
+	}
+	free(residues);
+	if (result != NULL)
+		*status = COMPOSED_OK;
+
+	return result;
+}
+
+/* ---------- Binomials ---------- */
+
+// returns 1 if p = a x^n + b with b nonzero
+static int is_binomial(polynomial p) {
+	sparse_polynomial *p_sparse = to_sparse_polynomial(p);
+	int result = (p_sparse->num_terms == 2) && (p_sparse->degrees[1] == 0);
+	free_sparse_polynomial(p_sparse);
+
+	return result;
+}
+
+// for p = a x^m + b and q = c x^n + d with b, d nonzero, every product of zeros satisfies z^L = (-b/a)^(n/g) (-d/c)^(m/g),
+// where g = gcd(m, n) and L = mn/g, and each of the L solutions occurs g times
+// so the composed product is (a^(n/g) c^(m/g) x^L - (-b)^(n/g) (-d)^(m/g))^g
+// returns NULL if the coefficients do not fit in an int
+// runtime: O(g)
+static polynomial *binomial_product(polynomial p, polynomial q) {
+	int g = gcd(p.deg, q.deg), l = p.deg / g * q.deg;
+	int a = p.coefficients[0], b = p.coefficients[p.deg], c = q.coefficients[0], d = q.coefficients[q.deg];
+	// (|lead| + |constant|)^g bounds every coefficient of the result
+	double bits = (q.deg / g) * log2(fabs((double) a)) + (p.deg / g) * log2(fabs((double) c));
+	double constant_bits = (q.deg / g) * log2(fabs((double) b)) + (p.deg / g) * log2(fabs((double) d));
+	double bound_bits = g * log2(pow(2.0, bits) + pow(2.0, constant_bits));
+	if (bound_bits >= 31)
+		return NULL;
+	long long lead = 1, constant = 1;
+	for (int i=0; i<q.deg/g; i++) {
+		lead *= a;
+		constant *= -b;
+	}
+	for (int i=0; i<p.deg/g; i++) {
+		lead *= c;
+		constant *= -d;
+	}
+	// expand (lead x^l - constant)^g with the binomial theorem
+	polynomial *result = calloc_polynomial(l * g);
+	long long binomial = 1, lead_power = 1, constant_power = 1;
+	for (int k=0; k<g; k++)
+		lead_power *= lead;
+	for (int k=0; k<=g; k++) {
+		result->coefficients[k * l] = (int) (binomial * lead_power * constant_power);
+		binomial = binomial * (g - k) / (k + 1);
+		if (k < g)
+			lead_power /= lead;
+		constant_power *= -constant;
+	}
+
+	return result;
+}
+
+/* ---------- Composed Sums and Products ---------- */
+
+// returns lc(p)^q.deg * lc(q)^p.deg * prod (x - (a + b)) over the zeros a of p and b of q
+// this is res_y(p(y), q(x - y)), or NULL if its coefficients do not fit in an int, with *status set as by composed_polynomial
+polynomial *composed_sum(polynomial p, polynomial q, composed_status *status) {
+	composed_expr p_leaf = {COMPOSED_LEAF, &p, NULL, NULL}, q_leaf = {COMPOSED_LEAF, &q, NULL, NULL};
+	composed_expr sum = {COMPOSED_SUM, NULL, &p_leaf, &q_leaf};
+
+	return composed_polynomial(sum, status);
+}
+
+// returns lc(p)^q.deg * lc(q)^p.deg * prod (x - a*b) over the zeros a of p and b of q
+// this is res_y(p(y), y^q.deg * q(x / y)), or NULL if its coefficients do not fit in an int, with *status set as by composed_polynomial
+// products of two binomials are given in closed form
+polynomial *composed_product(polynomial p, polynomial q, composed_status *status) {
+	if (is_binomial(p) && is_binomial(q)) {
+		polynomial *result = binomial_product(p, q);
+		if (status != NULL)
+			*status = (result != NULL) ? COMPOSED_OK : COMPOSED_OVERFLOW;
+		return result;
+	}
+	composed_expr p_leaf = {COMPOSED_LEAF, &p, NULL, NULL}, q_leaf = {COMPOSED_LEAF, &q, NULL, NULL};
+	composed_expr product = {COMPOSED_PRODUCT, NULL, &p_leaf, &q_leaf};
+
+	return composed_polynomial(product, status);
+}
+
+/* ---------- Testing ---------- */
+// to test, run "make test composed"
+
+#ifdef TEST_COMPOSED
+
+/* should output:
+ * composed_sum: x^4 - 10x^2 + 1
+ * composed_product: x^4 - 12x^2 + 36
+ * composed_sum: 4x^4 + 20x^3 + 23x^2 - 5x^1 - 11
+ * composed_product: 4x^4 + 6x^3 - 13x^2 - 3x^1 + 1
+ * overflow: 1
+ * composed_polynomial: 4x^4 - 20x^2 + 9
+ * zero inverse: 1
+ * binomial_product: x^6 - 72
+ * binomial_product: 144x^8 + 216x^4 + 81
+ * binomial_product: 1 */
+void test_composed_functions() {
+	polynomial *p = calloc_polynomial(2);
+	p->coefficients[0] = 1;
+	p->coefficients[2] = -2;
+	polynomial *q = calloc_polynomial(2);
+	q->coefficients[0] = 1;
+	q->coefficients[2] = -3;
+	printf("composed_sum: ");
+	print_polynomial(*composed_sum(*p, *q, NULL));
+	printf("composed_product: ");
+	print_polynomial(*composed_product(*p, *q, NULL));
+	// non-monic inputs
+	polynomial *f = alloc_polynomial(2);
+	f->coefficients[0] = 2;
+	f->coefficients[1] = -1;
+	f->coefficients[2] = -1;
+	polynomial *g = alloc_polynomial(2);
+	g->coefficients[0] = 1;
+	g->coefficients[1] = 3;
+	g->coefficients[2] = 1;
+	printf("composed_sum: ");
+	print_polynomial(*composed_sum(*f, *g, NULL));
+	printf("composed_product: ");
+	print_polynomial(*composed_product(*f, *g, NULL));
+	// the composed product of x^4 - 1000 with itself has constant term -10^12
+	polynomial *h = calloc_polynomial(4);
+	h->coefficients[0] = 1;
+	h->coefficients[4] = -1000;
+	composed_status status;
+	printf("overflow: %d\n", (composed_product(*h, *h, &status) == NULL) && (status == COMPOSED_OVERFLOW));
+	// sqrt(2) + 1/sqrt(2) and its conjugates
+	composed_expr p_leaf = {COMPOSED_LEAF, p, NULL, NULL};
+	composed_expr p_inverse = {COMPOSED_INVERT, NULL, &p_leaf, NULL};
+	composed_expr sum = {COMPOSED_SUM, NULL, &p_leaf, &p_inverse};
+	printf("composed_polynomial: ");
+	print_polynomial(*composed_polynomial(sum, NULL));
+	// x^2 - x has a zero at 0, which cannot be inverted
+	polynomial *r = calloc_polynomial(2);
+	r->coefficients[0] = 1;
+	r->coefficients[1] = -1;
+	composed_expr r_leaf = {COMPOSED_LEAF, r, NULL, NULL};
+	composed_expr r_inverse = {COMPOSED_INVERT, NULL, &r_leaf, NULL};
+	printf("zero inverse: %d\n", (composed_polynomial(r_inverse, &status) == NULL) && (status == COMPOSED_EVAL_FAILED));
+	// the closed form for binomials should agree with the general evaluation
+	polynomial *cube = calloc_polynomial(3);
+	cube->coefficients[0] = 1;
+	cube->coefficients[3] = -3;
+	printf("binomial_product: ");
+	print_polynomial(*composed_product(*p, *cube, NULL));
+	polynomial *s = calloc_polynomial(2);
+	s->coefficients[0] = 2;
+	s->coefficients[2] = -3;
+	polynomial *t = calloc_polynomial(4);
+	t->coefficients[0] = 3;
+	t->coefficients[4] = 1;
+	polynomial *closed_form = composed_product(*s, *t, NULL);
+	printf("binomial_product: ");
+	print_polynomial(*closed_form);
+	composed_expr s_leaf = {COMPOSED_LEAF, s, NULL, NULL}, t_leaf = {COMPOSED_LEAF, t, NULL, NULL};
+	composed_expr product = {COMPOSED_PRODUCT, NULL, &s_leaf, &t_leaf};
+	polynomial *general = composed_polynomial(product, NULL);
+	int agree = (closed_form->deg == general->deg);
+	for (int i=0; agree && (i<=general->deg); i++)
+		agree = (closed_form->coefficients[i] == general->coefficients[i]);
+	printf("binomial_product: %d\n", agree);
+}
+
+int main(int argc, char **argv) {
+	test_composed_functions();
+	exit(0);
+}
+
+#endif
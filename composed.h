@@ -0,0 +1,37 @@
+// composed.h
+// composed sums and products of polynomials, computed from the power sums of their zeros
+
+#ifndef COMPOSED_H
+#define COMPOSED_H
+
+#include "polynomial.h"
+
+typedef enum composed_op {
+	COMPOSED_LEAF,
+	COMPOSED_SUM,		// zeros a + b
+	COMPOSED_PRODUCT,	// zeros a * b
+	COMPOSED_NEGATE,	// zeros -a
+	COMPOSED_INVERT		// zeros 1 / a
+} composed_op;
+
+// why composed_polynomial returned NULL
+typedef enum composed_status {
+	COMPOSED_OK,
+	COMPOSED_OVERFLOW,		// the coefficients do not fit in an int, or are too large to bound with the prime table
+	COMPOSED_EVAL_FAILED	// an inverted polynomial has a zero at 0
+} composed_status;
+
+// an expression whose value is a polynomial, with zeros obtained by combining the zeros of the leaves
+typedef struct composed_expr {
+	composed_op op;
+	polynomial *leaf;						// only used by COMPOSED_LEAF
+	struct composed_expr *left, *right;		// right is unused by COMPOSED_NEGATE and COMPOSED_INVERT
+} composed_expr;
+
+polynomial *composed_polynomial(composed_expr, composed_status *);
+
+polynomial *composed_sum(polynomial, polynomial, composed_status *);
+
+polynomial *composed_product(polynomial, polynomial, composed_status *);
+
+#endif
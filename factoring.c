@@ -1,9 +1,978 @@
 // factoring.c
 // factors polynomials to obtain a factor containing the given root
+// uses the algorithm of zassenhaus: factor modulo a small prime, lift the factors with hensel's lemma, and recombine them
+// recombination is by trying subsets of the modular factors, or by lattice reduction when there are many
 
 #include "factoring.h"
+#include "integers.h"
+#include "modular.h"
+#include "gf_poly.h"
+#include "lll.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <assert.h>
 
-// default implimentation, not mathematically correct
+// number of suitable small primes tried, keeping the one giving the fewest modular factors
+#define FACTORING_PRIME_TRIALS 5
+// hensel lifting works modulo p^k < 2^HENSEL_MODULUS_BITS, so that products of residues fit in an unsigned __int128
+#define HENSEL_MODULUS_BITS 63
+// with more modular factors than this, factors are recombined by lattice reduction rather than by trying subsets
+#define VAN_HOEIJ_THRESHOLD 6
+// the trace columns of the knapsack lattice keep at least this many bits beyond one per modular factor
+#define VAN_HOEIJ_MARGIN_BITS 8
+// newton iterations used to refine a root before searching for a polynomial vanishing at it
+#define ROOT_REFINEMENT_ITERATIONS 100
+// number of word-size primes whose factorization degrees are compared by the irreducibility test
+#define IRREDUCIBILITY_PRIME_TRIALS 8
+
+/* ---------- Modular Arithmetic ---------- */
+
+// returns the representative of a mod m between -m/2 and m/2, for a in montgomery form
+static long long symmetric_residue(uint64_t a, modulus m) {
+	uint64_t residue = from_mod(a, m);
+	return (residue > m.p / 2) ? -(long long) (m.p - residue) : (long long) residue;
+}
+
+// returns a as a polynomial mod to, taking its coefficients between 0 and from.p - 1
+static gf_poly *change_modulus(gf_poly a, modulus from, modulus to) {
+	gf_poly *result = alloc_gf_poly(a.deg);
+	for (int i=0; i<=a.deg; i++) {
+		result->coefficients[i] = to_mod(from_mod(a.coefficients[i], from), to);
+	}
+	strip_gf_poly(result);
+
+	return result;
+}
+
+/* ---------- Integer Polynomials ---------- */
+
+// returns the gcd of the coefficients of p, with the sign of its leading coefficient
+static int content(polynomial p) {
+	int result = 0;
+	for (int i=0; i<=p.deg; i++) {
+		result = gcd(p.coefficients[i], result);
+	}
+	if ((result < 0) != (p.coefficients[0] < 0))
+		result = -result;
+	return (result == 0) ? 1 : result;
+}
+
+// returns p divided by its content, which has a positive leading coefficient
+polynomial *primitive_part(polynomial p) {
+	int c = content(p);
+	polynomial *result = alloc_polynomial(p.deg);
+	for (int i=0; i<=p.deg; i++) {
+		result->coefficients[i] = p.coefficients[i] / c;
+	}
+	return result;
+}
+
+// returns the polynomial with the coefficients of a, taken between -m/2 and m/2
+// returns NULL if a coefficient does not fit in an int
+static polynomial *lift_gf_poly(gf_poly a, modulus m) {
+	if (a.deg < 0)
+		return int_to_polynomial(0);
+	polynomial *result = alloc_polynomial(a.deg);
+	for (int i=0; i<=a.deg; i++) {
+		long long coefficient = symmetric_residue(a.coefficients[a.deg - i], m);
+		if ((coefficient > INT_MAX) || (coefficient < INT_MIN)) {
+			free_polynomial(result);
+			return NULL;
+		}
+		result->coefficients[i] = (int) coefficient;
+	}
+	return result;
+}
+
+// returns the primitive gcd of p and q over the integers, with positive leading coefficient
+// the gcd is computed modulo word-size primes, scaled by the gcd of the leading coefficients and checked by trial division
+// returns NULL if every prime in the table fails, which only happens if the gcd has enormous coefficients
+polynomial *gcd_polynomials(polynomial p, polynomial q) {
+	polynomial *p_primitive = primitive_part(p), *q_primitive = primitive_part(q);
+	int lc_gcd = abs(gcd(p_primitive->coefficients[0], q_primitive->coefficients[0]));
+	polynomial *result = NULL;
+	for (int i=0; (i<NUM_MODULAR_PRIMES) && (result == NULL); i++) {
+		modulus m = modular_prime(i);
+		// the prime must not divide either leading coefficient, so that degrees are preserved
+		if ((p.coefficients[0] % (long long) m.p == 0) || (q.coefficients[0] % (long long) m.p == 0))
+			continue;
+		gf_poly *p_mod = polynomial_to_gf_poly(*p_primitive, m), *q_mod = polynomial_to_gf_poly(*q_primitive, m);
+		gf_poly *g = gcd_gf_poly(*p_mod, *q_mod, m, NULL, NULL);
+		gf_poly *scaled = scale_gf_poly(*g, to_mod(lc_gcd, m), m);
+		polynomial *candidate = lift_gf_poly(*scaled, m);
+		free_gf_poly(p_mod);
+		free_gf_poly(q_mod);
+		free_gf_poly(g);
+		free_gf_poly(scaled);
+		if (candidate == NULL)
+			continue;
+		result = primitive_part(*candidate);
+		free_polynomial(candidate);
+		polynomial *p_quotient = divide_polynomials(*p_primitive, *result), *q_quotient = divide_polynomials(*q_primitive, *result);
+		if ((p_quotient == NULL) || (q_quotient == NULL)) {
+			free_polynomial(result);
+			result = NULL;
+		}
+		if (p_quotient != NULL)
+			free_polynomial(p_quotient);
+		if (q_quotient != NULL)
+			free_polynomial(q_quotient);
+	}
+	free_polynomial(p_primitive);
+	free_polynomial(q_primitive);
+
+	return result;
+}
+
+// returns the product of the distinct irreducible factors of p of positive degree, as a primitive polynomial
+// returns NULL if the gcd of p and its derivative could not be found
+polynomial *square_free_part(polynomial p) {
+	if (p.deg == 0)
+		return int_to_polynomial(1);
+	polynomial *derivative = differentiate(p);
+	polynomial *repeated = gcd_polynomials(p, *derivative);
+	free_polynomial(derivative);
+	if (repeated == NULL)
+		return NULL;
+	polynomial *p_primitive = primitive_part(p);
+	polynomial *result = divide_polynomials(*p_primitive, *repeated);
+	free_polynomial(p_primitive);
+	free_polynomial(repeated);
+
+	return result;
+}
+
+/* ---------- Hensel Lifting ---------- */
+
+// given f = g*h mod p with g monic and g, h coprime mod p, where f is known mod p^k
+// sets *g_lifted and *h_lifted so that f = g_lifted*h_lifted mod p^k, with g_lifted monic
+// lifts one power of p at a time
+// runtime: O(k*deg(f)^2)
+static void hensel_lift(gf_poly f, gf_poly g, gf_poly h, modulus p, int k, modulus p_k, gf_poly **g_lifted, gf_poly **h_lifted) {
+	gf_poly *s, *t;
+	free_gf_poly(gcd_gf_poly(g, h, p, &s, &t));	// s*g + t*h = 1 mod p
+	gf_poly *g_cur = change_modulus(g, p, p_k), *h_cur = change_modulus(h, p, p_k);
+	uint64_t p_power = p.p;
+	for (int j=1; j<k; j++) {
+		// the error f - g*h is divisible by p^j
+		gf_poly *product = mult_gf_poly(*g_cur, *h_cur, p_k);
+		gf_poly *residual = subtract_gf_poly(f, *product, p_k);
+		gf_poly *error = alloc_gf_poly(residual->deg);
+		for (int i=0; i<=residual->deg; i++) {
+			error->coefficients[i] = to_mod((from_mod(residual->coefficients[i], p_k) / p_power) % p.p, p);
+		}
+		strip_gf_poly(error);
+		// find a, b with a*h + b*g = error mod p and deg(a) < deg(g)
+		gf_poly *t_error = mult_gf_poly(*t, *error, p);
+		gf_poly *a = divide_gf_poly(*t_error, g, p, NULL);
+		gf_poly *a_h = mult_gf_poly(*a, h, p);
+		gf_poly *b_g = subtract_gf_poly(*error, *a_h, p);
+		gf_poly *b;
+		free_gf_poly(divide_gf_poly(*b_g, g, p, &b));
+		// add p^j*a to g and p^j*b to h
+		gf_poly *a_lifted = change_modulus(*a, p, p_k), *b_lifted = change_modulus(*b, p, p_k);
+		gf_poly *g_step = scale_gf_poly(*a_lifted, to_mod(p_power, p_k), p_k), *h_step = scale_gf_poly(*b_lifted, to_mod(p_power, p_k), p_k);
+		gf_poly *g_next = add_gf_poly(*g_cur, *g_step, p_k), *h_next = add_gf_poly(*h_cur, *h_step, p_k);
+		free_gf_poly(product);
+		free_gf_poly(residual);
+		free_gf_poly(error);
+		free_gf_poly(t_error);
+		free_gf_poly(a);
+		free_gf_poly(a_h);
+		free_gf_poly(b_g);
+		free_gf_poly(b);
+		free_gf_poly(a_lifted);
+		free_gf_poly(b_lifted);
+		free_gf_poly(g_step);
+		free_gf_poly(h_step);
+		free_gf_poly(g_cur);
+		free_gf_poly(h_cur);
+		g_cur = g_next;
+		h_cur = h_next;
+		p_power *= p.p;
+	}
+	free_gf_poly(s);
+	free_gf_poly(t);
+	*g_lifted = g_cur;
+	*h_lifted = h_cur;
+}
+
+// given f = lc*g_1*...*g_r mod p with each g_i monic, returns the monic lifts of the g_i mod p^k
+// f must be square-free mod p, and p must not divide lc
+static gf_poly **multifactor_lift(polynomial f, gf_poly **factors, int r, modulus p, int k, modulus p_k) {
+	gf_poly **result = (gf_poly**) malloc(sizeof(gf_poly*) * r);
+	gf_poly *remaining = polynomial_to_gf_poly(f, p_k);
+	for (int i=0; i<r-1; i++) {
+		// the cofactor of g_i mod p
+		gf_poly *h = alloc_gf_poly(0);
+		h->coefficients[0] = to_mod(from_mod(remaining->coefficients[remaining->deg], p_k) % p.p, p);
+		for (int j=i+1; j<r; j++) {
+			gf_poly *product = mult_gf_poly(*h, *factors[j], p);
+			free_gf_poly(h);
+			h = product;
+		}
+		gf_poly *h_lifted;
+		hensel_lift(*remaining, *factors[i], *h, p, k, p_k, &result[i], &h_lifted);
+		free_gf_poly(h);
+		free_gf_poly(remaining);
+		remaining = h_lifted;
+	}
+	result[r - 1] = monic_gf_poly(*remaining, p_k);
+	free_gf_poly(remaining);
+
+	return result;
+}
+
+/* ---------- Recombination ---------- */
+
+// returns lc times the product of the factors in subset, taken between -m/2 and m/2, as a primitive polynomial
+// returns NULL if this cannot be a factor of f because of its constant term or size
+static polynomial *subset_candidate(polynomial f, gf_poly **lifted, int *subset, int subset_size, modulus m) {
+	uint64_t lc = to_mod(f.coefficients[0], m);
+	// a true factor's constant term divides lc*f(0)
+	if (f.coefficients[f.deg] != 0) {
+		uint64_t constant = lc;
+		for (int i=0; i<subset_size; i++) {
+			constant = mod_mult(constant, lifted[subset[i]]->coefficients[0], m);
+		}
+		long long lifted_constant = symmetric_residue(constant, m);
+		if ((lifted_constant == 0) || ((__int128) f.coefficients[0] * f.coefficients[f.deg] % lifted_constant != 0))
+			return NULL;
+	}
+	gf_poly *product = alloc_gf_poly(0);
+	product->coefficients[0] = lc;
+	for (int i=0; i<subset_size; i++) {
+		gf_poly *next = mult_gf_poly(*product, *lifted[subset[i]], m);
+		free_gf_poly(product);
+		product = next;
+	}
+	polynomial *candidate = lift_gf_poly(*product, m);
+	free_gf_poly(product);
+	if (candidate == NULL)
+		return NULL;
+	polynomial *result = primitive_part(*candidate);
+	free_polynomial(candidate);
+
+	return result;
+}
+
+// finds the irreducible factors of f given the lifts of its modular factors, by trying products of subsets of them
+// subsets are tried in order of increasing size, and factors found are removed from f along with their subset
+// runtime: exponential in the number of modular factors
+static polynomial **recombine(polynomial f, gf_poly **lifted, int r, modulus m, int *num_factors) {
+	polynomial **result = (polynomial**) malloc(sizeof(polynomial*) * r);
+	*num_factors = 0;
+	polynomial *remaining = copy_polynomial(f);
+	int *subset = (int*) malloc(sizeof(int) * r);
+	for (int size=1; 2*size<=r; size++) {
+		// iterate over subsets in lexicographic order
+		for (int i=0; i<size; i++) {
+			subset[i] = i;
+		}
+		int done = 0;
+		while (!done) {
+			polynomial *candidate = subset_candidate(*remaining, lifted, subset, size, m);
+			polynomial *quotient = (candidate != NULL) ? divide_polynomials(*remaining, *candidate) : NULL;
+			if (quotient != NULL) {
+				result[(*num_factors)++] = candidate;
+				free_polynomial(remaining);
+				remaining = quotient;
+				// remove the subset from the list of modular factors
+				int kept = 0;
+				for (int i=0, j=0; i<r; i++) {
+					if ((j < size) && (subset[j] == i)) {
+						free_gf_poly(lifted[i]);
+						j++;
+					} else {
+						lifted[kept++] = lifted[i];
+					}
+				}
+				r = kept;
+				for (int i=0; i<size; i++) {
+					subset[i] = i;
+				}
+				done = (2*size > r);
+				continue;
+			}
+			if (candidate != NULL)
+				free_polynomial(candidate);
+			// advance to the next subset
+			int i = size - 1;
+			while ((i >= 0) && (subset[i] == r - size + i)) {
+				i--;
+			}
+			if (i < 0) {
+				done = 1;
+			} else {
+				subset[i]++;
+				for (int j=i+1; j<size; j++) {
+					subset[j] = subset[j - 1] + 1;
+				}
+			}
+		}
+	}
+	// the remaining modular factors form a single irreducible factor
+	if (remaining->deg > 0)
+		result[(*num_factors)++] = remaining;
+	else
+		free_polynomial(remaining);
+	for (int i=0; i<r; i++) {
+		free_gf_poly(lifted[i]);
+	}
+	free(subset);
+
+	return result;
+}
+
+/* ---------- Lattice Recombination ---------- */
+
+// returns the power sums s_1, ..., s_n of the roots of the monic polynomial g mod m, by newton's identities
+static uint64_t *mod_power_sums(gf_poly g, int n, modulus m) {
+	uint64_t *result = (uint64_t*) malloc(sizeof(uint64_t) * (n + 1));
+	result[0] = to_mod(g.deg, m);
+	for (int j=1; j<=n; j++) {
+		// s_j = -(j*e_j + sum_(i=1)^(j-1) c_(d-i)*s_(j-i)), where c_(d-i) is the coefficient of x^(d-i)
+		uint64_t sum = (j <= g.deg) ? mod_mult(to_mod(j, m), g.coefficients[g.deg - j], m) : 0;
+		for (int i=1; (i<j) && (i<=g.deg); i++) {
+			sum = mod_add(sum, mod_mult(g.coefficients[g.deg - i], result[j - i], m), m);
+		}
+		result[j] = mod_neg(sum, m);
+	}
+	return result;
+}
+
+// recombines the lifted modular factors of f mod p^k by the knapsack method of van hoeij
+// the lattice is spanned by rows (e_i, t_i1, ..., t_iN) for each modular factor, and the moduli of the trace columns
+// where t_ij is the jth power sum of the roots of lc(f)*g_i with the low digits which may be nonzero for a true factor cut off
+// indicator vectors of true factors are short in it, and after lll they span the first rows of the basis
+// returns NULL if the lattice does not determine the factors, so that they can be found by trying subsets instead
+static polynomial **van_hoeij_recombine(polynomial f, gf_poly **lifted, int r, uint64_t p, modulus m, int *num_factors) {
+	// a bound on |lc(f)*a| for every root a of f, using fujiwara's bound
+	double root_bound = 0;
+	for (int i=1; i<=f.deg; i++) {
+		double term = pow(fabs((double) f.coefficients[i] / f.coefficients[0]), 1.0 / i);
+		if (i == f.deg)
+			term = pow(fabs((double) f.coefficients[i] / (2.0 * f.coefficients[0])), 1.0 / i);
+		if (term > root_bound)
+			root_bound = term;
+	}
+	double log2_scaled_root = log2(fabs((double) f.coefficients[0]) * 2 * root_bound);
+	// choose how many traces to use, and the power of p cut off each
+	uint64_t *cuts = (uint64_t*) malloc(sizeof(uint64_t) * (r + 1));
+	int num_traces = 0;
+	for (int j=1; (j<=r) && (j<=f.deg); j++) {
+		// the power sums of a true factor are at most deg(f)*|lc(f)*a|^j
+		double bound_bits = log2((double) f.deg) + j * log2_scaled_root + 1;
+		uint64_t cut = 1;
+		while ((log2((double) cut) < bound_bits) && (cut <= m.p / p)) {
+			cut *= p;
+		}
+		if ((log2((double) cut) < bound_bits) || (log2((double) (m.p / cut)) < r + VAN_HOEIJ_MARGIN_BITS))
+			break;
+		cuts[++num_traces] = cut;
+	}
+	if (num_traces == 0) {
+		free(cuts);
+		return NULL;
+	}
+	// traces of lc(f)*g_i: s_j(lc(f)*g_i) = lc(f)^j * s_j(g_i)
+	int dim = r + num_traces;
+	matrix *basis = alloc_matrix(dim, dim);
+	for (int i=0; i<dim; i++) {
+		for (int j=0; j<dim; j++) {
+			basis->entries[i][j] = (i == j);
+		}
+	}
+	uint64_t lc = to_mod(f.coefficients[0], m);
+	for (int i=0; i<r; i++) {
+		uint64_t *sums = mod_power_sums(*lifted[i], num_traces, m);
+		uint64_t lc_power = to_mod(1, m);
+		for (int j=1; j<=num_traces; j++) {
+			lc_power = mod_mult(lc_power, lc, m);
+			basis->entries[i][r + j - 1] = (matrix_entry) (from_mod(mod_mult(sums[j], lc_power, m), m) / cuts[j]);
+		}
+		free(sums);
+	}
+	for (int j=1; j<=num_traces; j++) {
+		basis->entries[r + j - 1][r + j - 1] = (matrix_entry) (m.p / cuts[j]);
+	}
+	free(cuts);
+	polynomial **result = NULL;
+	if (lll_reduce(*basis)) {
+		// keep the leading vectors whose gram-schmidt norms are within the bound on indicator vectors
+		// ||(e_S, t_S)||^2 <= r + num_traces*(r + 1)^2
+		matrix_entry bound = r + (matrix_entry) num_traces * (r + 1) * (r + 1);
+		matrix *orthogonal = copy_matrix(*basis);
+		int s = 0;
+		for (int i=0; i<dim; i++) {
+			for (int j=0; j<i; j++) {
+				matrix_entry numerator = 0, denominator = 0;
+				for (int l=0; l<dim; l++) {
+					numerator += basis->entries[i][l] * orthogonal->entries[j][l];
+					denominator += orthogonal->entries[j][l] * orthogonal->entries[j][l];
+				}
+				for (int l=0; l<dim; l++) {
+					orthogonal->entries[i][l] -= numerator / denominator * orthogonal->entries[j][l];
+				}
+			}
+			matrix_entry norm = 0;
+			for (int l=0; l<dim; l++) {
+				norm += orthogonal->entries[i][l] * orthogonal->entries[i][l];
+			}
+			if (norm <= bound)
+				s = i + 1;
+		}
+		free_matrix(orthogonal);
+		// modular factors belong to the same true factor exactly when their columns in the short vectors agree
+		int *group = (int*) malloc(sizeof(int) * r);
+		int num_groups = 0;
+		for (int i=0; i<r; i++) {
+			group[i] = -1;
+			for (int j=0; (j<i) && (group[i] < 0); j++) {
+				int same = 1;
+				for (int l=0; (l<s) && same; l++) {
+					same = (basis->entries[l][i] == basis->entries[l][j]);
+				}
+				if (same)
+					group[i] = group[j];
+			}
+			if (group[i] < 0)
+				group[i] = num_groups++;
+		}
+		if ((s > 0) && (num_groups == s)) {
+			// confirm each group by trial division
+			result = (polynomial**) malloc(sizeof(polynomial*) * num_groups);
+			polynomial *remaining = copy_polynomial(f);
+			int *subset = (int*) malloc(sizeof(int) * r);
+			*num_factors = 0;
+			for (int g=0; (g<num_groups) && (result != NULL); g++) {
+				int size = 0;
+				for (int i=0; i<r; i++) {
+					if (group[i] == g)
+						subset[size++] = i;
+				}
+				polynomial *candidate = subset_candidate(*remaining, lifted, subset, size, m);
+				polynomial *quotient = (candidate != NULL) ? divide_polynomials(*remaining, *candidate) : NULL;
+				if (quotient == NULL) {
+					if (candidate != NULL)
+						free_polynomial(candidate);
+					for (int i=0; i<*num_factors; i++) {
+						free_polynomial(result[i]);
+					}
+					free(result);
+					result = NULL;
+				} else {
+					result[(*num_factors)++] = candidate;
+					free_polynomial(remaining);
+					remaining = quotient;
+				}
+			}
+			free_polynomial(remaining);
+			free(subset);
+		}
+		free(group);
+	}
+	free_matrix(basis);
+
+	return result;
+}
+
+/* ---------- Factoring ---------- */
+
+// returns log2 of a bound on the coefficients of lc(f)*g for any factor g of f, capped at what fits in int
+static double log2_factor_bound(polynomial f) {
+	double norm = 0;
+	for (int i=0; i<=f.deg; i++) {
+		norm += (double) f.coefficients[i] * f.coefficients[i];
+	}
+	// mignotte: the coefficients of a factor are at most 2^deg(f) * ||f||_2
+	double result = f.deg + log2(norm) / 2;
+	if (result > 31)
+		result = 31;
+	return result + log2(fabs((double) f.coefficients[0]));
+}
+
+static int is_small_prime(uint64_t n) {
+	if (n < 2)
+		return 0;
+	for (uint64_t i=2; i*i<=n; i++) {
+		if (n % i == 0)
+			return 0;
+	}
+	return 1;
+}
+
+// returns the monic irreducible factors of f modulo the small prime giving the fewest of them, and sets *prime to that prime
+// f must be square-free with positive degree
+static gf_poly **modular_factorization(polynomial f, uint64_t *prime, int *num_factors) {
+	gf_poly **result = NULL;
+	*num_factors = 0;
+	int trials = 0;
+	for (uint64_t p=3; (trials < FACTORING_PRIME_TRIALS) && (*num_factors != 1); p+=2) {
+		if (!is_small_prime(p) || (f.coefficients[0] % (long long) p == 0))
+			continue;
+		modulus m = init_modulus(p);
+		gf_poly *f_mod = polynomial_to_gf_poly(f, m);
+		gf_poly *derivative = differentiate_gf_poly(*f_mod, m);
+		gf_poly *g = gcd_gf_poly(*f_mod, *derivative, m, NULL, NULL);
+		int square_free = (g->deg == 0);
+		free_gf_poly(derivative);
+		free_gf_poly(g);
+		if (square_free) {
+			trials++;
+			int count;
+			gf_poly **factors = factor_gf_poly(*f_mod, m, &count);
+			if ((result == NULL) || (count < *num_factors)) {
+				if (result != NULL) {
+					for (int i=0; i<*num_factors; i++) {
+						free_gf_poly(result[i]);
+					}
+					free(result);
+				}
+				*prime = p;
+				result = factors;
+				*num_factors = count;
+			} else {
+				for (int i=0; i<count; i++) {
+					free_gf_poly(factors[i]);
+				}
+				free(factors);
+			}
+		}
+		free_gf_poly(f_mod);
+	}
+
+	return result;
+}
+
+// returns the irreducible factors of f, which must be primitive and square-free with positive degree
+// with many modular factors, recombination is by lattice reduction, falling back to trying subsets if that fails
+static polynomial **factor_square_free(polynomial f, int *num_factors) {
+	if (f.deg == 1) {
+		polynomial **result = (polynomial**) malloc(sizeof(polynomial*));
+		result[0] = copy_polynomial(f);
+		*num_factors = 1;
+		return result;
+	}
+	uint64_t p = 0;
+	int r;
+	gf_poly **factors = modular_factorization(f, &p, &r);
+	if (r == 1) {
+		free_gf_poly(factors[0]);
+		free(factors);
+		polynomial **result = (polynomial**) malloc(sizeof(polynomial*));
+		result[0] = copy_polynomial(f);
+		*num_factors = 1;
+		return result;
+	}
+	// lift until p^k bounds twice the coefficients of lc(f) times any factor
+	// lattice reduction uses the extra precision, so lift as far as possible in that case
+	int use_lattice = (r > VAN_HOEIJ_THRESHOLD);
+	double bits = use_lattice ? HENSEL_MODULUS_BITS : log2_factor_bound(f) + 1;
+	int k = 1;
+	uint64_t p_k = p;
+	while ((log2((double) p_k) < bits) && (log2((double) p_k) + log2((double) p) < HENSEL_MODULUS_BITS)) {
+		p_k *= p;
+		k++;
+	}
+	modulus m = init_modulus(p_k);
+	gf_poly **lifted = multifactor_lift(f, factors, r, init_modulus(p), k, m);
+	for (int i=0; i<r; i++) {
+		free_gf_poly(factors[i]);
+	}
+	free(factors);
+	polynomial **result = use_lattice ? van_hoeij_recombine(f, lifted, r, p, m, num_factors) : NULL;
+	if (result != NULL) {
+		for (int i=0; i<r; i++) {
+			free_gf_poly(lifted[i]);
+		}
+		return result;
+	}
+
+	return recombine(f, lifted, r, m, num_factors);
+}
+
+// returns the distinct irreducible factors of p of positive degree, each primitive with a positive leading coefficient
+// returns NULL if p could not be made square-free
+polynomial **factor_polynomial(polynomial p, int *num_factors) {
+	*num_factors = 0;
+	if (p.deg == 0)
+		return (polynomial**) malloc(sizeof(polynomial*));
+	polynomial *square_free = square_free_part(p);
+	if (square_free == NULL)
+		return NULL;
+	polynomial **result = factor_square_free(*square_free, num_factors);
+	free_polynomial(square_free);
+
+	return result;
+}
+
+// returns |p(x)| divided by the sum of the absolute values of its terms at x
+// this is near 0 only if x is near a root of p
+static long double relative_residual(polynomial p, long double x) {
+	long double value = 0, magnitude = 0;
+	for (int i=0; i<=p.deg; i++) {
+		value = value * x + p.coefficients[i];
+		magnitude = magnitude * fabsl(x) + abs(p.coefficients[i]);
+	}
+	return fabsl(value) / magnitude;
+}
+
+// returns the factor which has a root in b, freeing the others
+// if the ball does not isolate a single factor, the one closest to vanishing at its center is taken
+static polynomial *select_factor(polynomial **factors, int num_factors, ball b) {
+	// prefer factors which change sign across the ball
+	int num_sign_changes = 0;
+	for (int i=0; i<num_factors; i++) {
+		num_sign_changes += test_for_root(*factors[i], b);
+	}
+	int best = -1;
+	long double best_residual = 0;
+	for (int i=0; i<num_factors; i++) {
+		if ((num_sign_changes > 0) && !test_for_root(*factors[i], b))
+			continue;
+		long double residual = relative_residual(*factors[i], b.center);
+		if ((best < 0) || (residual < best_residual)) {
+			best = i;
+			best_residual = residual;
+		}
+	}
+	for (int i=0; i<num_factors; i++) {
+		if (i != best)
+			free_polynomial(factors[i]);
+	}
+	polynomial *result = factors[best];
+	free(factors);
+
+	return result;
+}
+
+/* ---------- Irreducibility ---------- */
+
+// tests whether p is irreducible over the rationals, from the degrees of its factors modulo a few word-size primes
+// the degree of a factor over the integers is a sum of degrees of modular factors for every prime,
+// so p is irreducible if no degree strictly between 0 and deg(p) is such a sum for all the primes tried
+// only distinct-degree factorization is needed, and the primes come from the table in modular.h
+// returns IRREDUCIBILITY_UNKNOWN if the primes do not decide, as for polynomials reducible modulo every prime
+irreducibility test_irreducibility(polynomial p) {
+	if (p.deg == 0)
+		return IRREDUCIBILITY_REDUCIBLE;
+	if (p.deg == 1)
+		return IRREDUCIBILITY_IRREDUCIBLE;
+	polynomial *square_free = square_free_part(p);
+	if (square_free == NULL)
+		return IRREDUCIBILITY_UNKNOWN;
+	int repeated_factor = (square_free->deg < p.deg);
+	free_polynomial(square_free);
+	if (repeated_factor)
+		return IRREDUCIBILITY_REDUCIBLE;
+	// possible[d] is set while d can still be the degree of a factor
+	char *possible = (char*) malloc(sizeof(char) * (p.deg + 1));
+	for (int d=0; d<=p.deg; d++) {
+		possible[d] = 1;
+	}
+	int num_possible = p.deg - 1;
+	for (int i=0; (i<IRREDUCIBILITY_PRIME_TRIALS) && (num_possible > 0); i++) {
+		modulus m = modular_prime(i);
+		// the prime exceeds every coefficient, so the degree is preserved, but p may not be square-free modulo it
+		gf_poly *p_mod = polynomial_to_gf_poly(p, m);
+		gf_poly *derivative = differentiate_gf_poly(*p_mod, m);
+		gf_poly *g = gcd_gf_poly(*p_mod, *derivative, m, NULL, NULL);
+		int square_free_mod = (g->deg == 0);
+		free_gf_poly(derivative);
+		free_gf_poly(g);
+		if (!square_free_mod) {
+			free_gf_poly(p_mod);
+			continue;
+		}
+		gf_poly **parts = distinct_degree_factorization(*p_mod, m);
+		char *sums = (char*) calloc(p.deg + 1, sizeof(char));
+		sums[0] = 1;
+		for (int d=1; d<=p.deg; d++) {
+			for (int j=0; j<parts[d]->deg/d; j++) {
+				for (int s=p.deg; s>=d; s--) {
+					sums[s] |= sums[s - d];
+				}
+			}
+		}
+		num_possible = 0;
+		for (int d=1; d<p.deg; d++) {
+			possible[d] &= sums[d];
+			num_possible += possible[d];
+		}
+		for (int d=0; d<=p.deg; d++) {
+			free_gf_poly(parts[d]);
+		}
+		free(parts);
+		free(sums);
+		free_gf_poly(p_mod);
+	}
+	free(possible);
+
+	return (num_possible == 0) ? IRREDUCIBILITY_IRREDUCIBLE : IRREDUCIBILITY_UNKNOWN;
+}
+
+/* ---------- Root-Guided Search ---------- */
+
+// refines the root of f in b by newton's method in matrix_entry precision
+// returns 0 if the iteration does not converge within the ball
+static int refine_root(polynomial f, ball b, matrix_entry *root) {
+	matrix_entry x = b.center, step = 1;
+	for (int i=0; (i<ROOT_REFINEMENT_ITERATIONS) && (step != 0); i++) {
+		matrix_entry value = 0, derivative = 0;
+		for (int j=0; j<=f.deg; j++) {
+			derivative = derivative * x + value;
+			value = value * x + f.coefficients[j];
+		}
+		if (derivative == 0)
+			return 0;
+		step = value / derivative;
+		matrix_entry next = x - step;
+		// stop once the step is lost in rounding
+		if (next == x)
+			break;
+		x = next;
+	}
+	*root = x;
+
+	return (x >= b.center - b.radius) && (x <= b.center + b.radius);
+}
+
+// returns the primitive integer polynomial of degree at most d with a short coefficient vector which nearly vanishes at alpha
+// found by lattice reduction on the rows (e_i, C*alpha^i), where C scales the largest power of alpha to about 2^RELATION_BITS
+// returns NULL if the relation found has degree below d or coefficients too large for an int
+static polynomial *integer_relation(matrix_entry alpha, int d) {
+	matrix_entry max_power = 1, abs_alpha = (alpha < 0) ? -alpha : alpha;
+	for (int i=0; i<d; i++) {
+		if (abs_alpha > 1)
+			max_power *= abs_alpha;
+	}
+	matrix_entry *powers = (matrix_entry*) malloc(sizeof(matrix_entry) * (d + 1));
+	matrix_entry *relation = (matrix_entry*) malloc(sizeof(matrix_entry) * (d + 1));
+	powers[0] = 1;
+	for (int i=1; i<=d; i++) {
+		powers[i] = powers[i - 1] * alpha;
+	}
+	polynomial *result = NULL;
+	if (find_integer_relation(powers, d + 1, 0x1p100Q / max_power, relation) && (relation[d] != 0)) {
+		result = alloc_polynomial(d);
+		for (int i=0; (i<=d) && (result != NULL); i++) {
+			matrix_entry coefficient = relation[d - i];
+			if ((coefficient > INT_MAX) || (coefficient < INT_MIN)) {
+				free_polynomial(result);
+				result = NULL;
+			} else {
+				result->coefficients[i] = (int) coefficient;
+			}
+		}
+	}
+	free(powers);
+	free(relation);
+	if (result == NULL)
+		return NULL;
+	polynomial *primitive = primitive_part(*result);
+	free_polynomial(result);
+
+	return primitive;
+}
+
+// finds the irreducible factor of the square-free polynomial f with a root in b, without factoring f completely
+// the root is refined, and for each degree a factor could have, given the degrees of the modular factors of f,
+// a polynomial vanishing at the root is sought by lattice reduction and checked by trial division
+// the first one found is irreducible if the lattice search is exact; this is confirmed by finding a prime modulo which it is irreducible,
+// and otherwise only that polynomial is factored
+// returns NULL if no factor is found this way
+static polynomial *root_guided_factor(polynomial f, ball b) {
+	if (f.deg == 1)
+		return copy_polynomial(f);
+	matrix_entry root;
+	if (!refine_root(f, b, &root))
+		return NULL;
+	uint64_t p = 0;
+	int r;
+	gf_poly **factors = modular_factorization(f, &p, &r);
+	// the degrees of true factors are sums of degrees of modular factors
+	char *possible = (char*) calloc(f.deg + 1, sizeof(char));
+	possible[0] = 1;
+	for (int i=0; i<r; i++) {
+		for (int d=f.deg; d>=factors[i]->deg; d--) {
+			possible[d] |= possible[d - factors[i]->deg];
+		}
+		free_gf_poly(factors[i]);
+	}
+	free(factors);
+	polynomial *result = NULL;
+	if (r == 1)
+		result = copy_polynomial(f);
+	for (int d=1; (d<f.deg) && (result == NULL); d++) {
+		if (!possible[d])
+			continue;
+		polynomial *candidate = integer_relation(root, d);
+
+		if ((candidate != NULL) && (relative_residual(*candidate, (long double) root) > MIN_ROOT_ERR)) {
+			free_polynomial(candidate);
+			candidate = NULL;
+		}
+		polynomial *quotient = (candidate != NULL) ? divide_polynomials(f, *candidate) : NULL;
+		if (quotient == NULL) {
+			if (candidate != NULL)
+				free_polynomial(candidate);
+			continue;
+		}
+		free_polynomial(quotient);
+		int num_factors;
+		gf_poly **candidate_factors = modular_factorization(*candidate, &p, &num_factors);
+		for (int i=0; i<num_factors; i++) {
+			free_gf_poly(candidate_factors[i]);
+		}
+		free(candidate_factors);
+		if (num_factors == 1) {
+			result = candidate;
+		} else {
+			polynomial **candidate_split = factor_square_free(*candidate, &num_factors);
+			free_polynomial(candidate);
+			result = select_factor(candidate_split, num_factors, b);
+		}
+	}
+	free(possible);
+
+	return result;
+}
+
+/* ---------- Finding Factors ---------- */
+
+// returns the irreducible factor of p which has a root in b
+// tries the root-guided search first, and otherwise factors p completely
+// if the ball does not isolate a single factor, the one closest to vanishing at its center is taken
+// if p cannot be factored, returns a copy of p
 polynomial *find_factor(polynomial p, ball b) {
-	return copy_polynomial(p);
+	polynomial *square_free = (p.deg > 0) ? square_free_part(p) : NULL;
+	if (square_free == NULL)
+		return copy_polynomial(p);
+	polynomial *result = root_guided_factor(*square_free, b);
+	if (result == NULL) {
+		int num_factors;
+		polynomial **factors = factor_square_free(*square_free, &num_factors);
+		result = select_factor(factors, num_factors, b);
+	}
+	free_polynomial(square_free);
+
+	return result;
+}
+
+/* ---------- Testing ---------- */
+// to test, run "make test factoring"
+
+#ifdef TEST_FACTORING
+
+static polynomial *from_coefficients(int deg, int *coefficients) {
+	polynomial *result = alloc_polynomial(deg);
+	for (int i=0; i<=deg; i++) {
+		result->coefficients[i] = coefficients[i];
+	}
+	return result;
 }
+
+/* should output:
+ * gcd_polynomials: x^1 - 1
+ * square_free_part: x^3 - 8x^1
+ * factor_polynomial: 2 factors
+ * 3x^1 + 1
+ * 2x^1 + 1
+ * factor_polynomial: 1 factors
+ * x^4 - 10x^2 + 1
+ * find_factor: x^2 - 3
+ * find_factor: x^2 - 8
+ * find_factor: x^4 - 10x^2 + 1
+ * van_hoeij_recombine: 3 factors
+ * x^2 - 5
+ * x^4 - 10x^2 + 1
+ * x^8 - 40x^6 + 352x^4 - 960x^2 + 576
+ * find_factor: x^8 - 40x^6 + 352x^4 - 960x^2 + 576
+ * root_guided_factor: x^8 - 40x^6 + 352x^4 - 960x^2 + 576
+ * root_guided_factor: x^4 - 10x^2 + 1
+ * test_irreducibility: 1, 0, 2 */
+void test_factoring() {
+	// (x - 1)^2 (x + 2) and (x - 1)(x + 3)
+	int p_coefficients[] = {1, 0, -3, 2}, q_coefficients[] = {1, 2, -3};
+	polynomial *p = from_coefficients(3, p_coefficients), *q = from_coefficients(2, q_coefficients);
+	printf("gcd_polynomials: ");
+	print_polynomial(*gcd_polynomials(*p, *q));
+	// x^2 (x^2 - 8)^2 (x^2 - 8 has no repeated roots, but sqrt(2) + sqrt(2) appears twice in the resultant)
+	int repeated_coefficients[] = {1, 0, -16, 0, 64, 0, 0};
+	polynomial *repeated = from_coefficients(6, repeated_coefficients);
+	printf("square_free_part: ");
+	print_polynomial(*square_free_part(*repeated));
+	// 6x^2 + 5x + 1 = (2x + 1)(3x + 1)
+	int non_monic_coefficients[] = {6, 5, 1};
+	int num_factors;
+	polynomial **factors = factor_polynomial(*from_coefficients(2, non_monic_coefficients), &num_factors);
+	printf("factor_polynomial: %d factors\n", num_factors);
+	for (int i=0; i<num_factors; i++) {
+		print_polynomial(*factors[i]);
+	}
+	// irreducible, but splits into linear or quadratic factors modulo every prime
+	int swinnerton_dyer_coefficients[] = {1, 0, -10, 0, 1};
+	polynomial *swinnerton_dyer = from_coefficients(4, swinnerton_dyer_coefficients);
+	factors = factor_polynomial(*swinnerton_dyer, &num_factors);
+	printf("factor_polynomial: %d factors\n", num_factors);
+	for (int i=0; i<num_factors; i++) {
+		print_polynomial(*factors[i]);
+	}
+	// (x^2 - 2)(x^2 - 3) at sqrt(3)
+	int product_coefficients[] = {1, 0, -5, 0, 6};
+	printf("find_factor: ");
+	print_polynomial(*find_factor(*from_coefficients(4, product_coefficients), *new_ball(sqrt(3), 1e-12)));
+	// the resultant for sqrt(2) + sqrt(2)
+	printf("find_factor: ");
+	print_polynomial(*find_factor(*repeated, *new_ball(2 * sqrt(2), 1e-12)));
+	// (x^4 - 10x^2 + 1)(x^2 - 2) at sqrt(2) + sqrt(3)
+	polynomial *x2_minus_2 = from_coefficients(2, q_coefficients);
+	x2_minus_2->coefficients[1] = 0;
+	x2_minus_2->coefficients[2] = -2;
+	printf("find_factor: ");
+	print_polynomial(*find_factor(*mult_polynomials(*swinnerton_dyer, *x2_minus_2), *new_ball(sqrt(2) + sqrt(3), 1e-12)));
+	// (x^2 - 5)(x^4 - 10x^2 + 1)(x^8 - 40x^6 + 352x^4 - 960x^2 + 576) has at least 7 factors modulo every prime
+	int sd3_coefficients[] = {1, 0, -40, 0, 352, 0, -960, 0, 576};
+	polynomial *x2_minus_5 = copy_polynomial(*x2_minus_2);
+	x2_minus_5->coefficients[2] = -5;
+	polynomial *many = mult_polynomials(*mult_polynomials(*x2_minus_5, *swinnerton_dyer), *from_coefficients(8, sd3_coefficients));
+	uint64_t prime;
+	int r;
+	gf_poly **modular_factors = modular_factorization(*many, &prime, &r);
+	uint64_t modulus = prime;
+	int k = 1;
+	while (modulus <= (1ULL << (HENSEL_MODULUS_BITS - 1)) / prime) {
+		modulus *= prime;
+		k++;
+	}
+	gf_poly **lifted = multifactor_lift(*many, modular_factors, r, init_modulus(prime), k, init_modulus(modulus));
+	factors = van_hoeij_recombine(*many, lifted, r, prime, init_modulus(modulus), &num_factors);
+	printf("van_hoeij_recombine: %d factors\n", (factors == NULL) ? 0 : num_factors);
+	for (int i=0; (factors != NULL) && (i<num_factors); i++) {
+		print_polynomial(*factors[i]);
+	}
+	// sqrt(2) + sqrt(3) + sqrt(5)
+	printf("find_factor: ");
+	print_polynomial(*find_factor(*many, *new_ball(sqrt(2) + sqrt(3) + sqrt(5), 1e-12)));
+	printf("root_guided_factor: ");
+	print_polynomial(*root_guided_factor(*many, *new_ball(sqrt(2) + sqrt(3) + sqrt(5), 1e-12)));
+	// sqrt(2) - sqrt(3) is a root of (x^4 - 10x^2 + 1)(x^2 - 2), and the ball is loose
+	printf("root_guided_factor: ");
+	print_polynomial(*root_guided_factor(*mult_polynomials(*swinnerton_dyer, *x2_minus_2), *new_ball(sqrt(2) - sqrt(3), 1e-3)));
+	// x^5 - x + 1 is irreducible, x^4 - 10x^2 + 1 is irreducible but reducible modulo every prime, and (x^2 - 2)^2 is not square-free
+	int quintic_coefficients[] = {1, 0, 0, 0, -1, 1};
+	printf("test_irreducibility: %d, ", test_irreducibility(*from_coefficients(5, quintic_coefficients)));
+	printf("%d, ", test_irreducibility(*swinnerton_dyer));
+	printf("%d\n", test_irreducibility(*mult_polynomials(*x2_minus_2, *x2_minus_2)));
+}
+
+int main(int argc, char **argv) {
+	test_factoring();
+	exit(0);
+}
+
+#endif
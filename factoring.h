@@ -6,6 +6,23 @@
 #include "polynomial.h"
 #include "roots.h"
 
+// what is known about the irreducibility of a polynomial over the rationals
+typedef enum irreducibility {
+	IRREDUCIBILITY_UNKNOWN,
+	IRREDUCIBILITY_IRREDUCIBLE,
+	IRREDUCIBILITY_REDUCIBLE
+} irreducibility;
+
+polynomial *primitive_part(polynomial);
+
+polynomial *gcd_polynomials(polynomial, polynomial);
+
+polynomial *square_free_part(polynomial);
+
+polynomial **factor_polynomial(polynomial, int *);
+
+irreducibility test_irreducibility(polynomial);
+
 polynomial *find_factor(polynomial, ball);
 
 #endif
@@ -0,0 +1,746 @@
+// gf_poly.c
+// implements arithmetic, modular composition and factoring of polynomials over GF(p) for word-size primes
+
+#include "gf_poly.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#define GF_POLY_ALIGN 64	// alignment in bytes of coefficient arrays
+
+/* ---------- Memory Functions ---------- */
+
+// the coefficients are initialized to 0
+gf_poly *alloc_gf_poly(int degree) {
+	gf_poly *result = (gf_poly*) malloc(sizeof(gf_poly));
+	result->deg = degree;
+	// pad to a whole number of aligned blocks
+	int words_per_align = GF_POLY_ALIGN / sizeof(uint64_t);
+	int length = (degree < 0) ? 1 : degree + 1;
+	length = ((length + words_per_align - 1) / words_per_align) * words_per_align;
+	void *data = NULL;
+	int alloc_failed = posix_memalign(&data, GF_POLY_ALIGN, sizeof(uint64_t) * length);
+	assert(!alloc_failed);
+	memset(data, 0, sizeof(uint64_t) * length);
+	result->coefficients = (uint64_t*) data;
+
+	return result;
+}
+
+void free_gf_poly(gf_poly *p) {
+	free(p->coefficients);
+	free(p);
+}
+
+gf_poly *copy_gf_poly(gf_poly p) {
+	gf_poly *result = alloc_gf_poly(p.deg);
+	for (int i=0; i<=p.deg; i++) {
+		result->coefficients[i] = p.coefficients[i];
+	}
+	return result;
+}
+
+// lowers the degree past any zero leading coefficients
+void strip_gf_poly(gf_poly *p) {
+	while ((p->deg >= 0) && (p->coefficients[p->deg] == 0)) {
+		p->deg--;
+	}
+}
+
+gf_poly *polynomial_to_gf_poly(polynomial p, modulus m) {
+	gf_poly *result = alloc_gf_poly(p.deg);
+	for (int i=0; i<=p.deg; i++) {
+		result->coefficients[i] = to_mod(p.coefficients[p.deg - i], m);
+	}
+	strip_gf_poly(result);
+
+	return result;
+}
+
+/* ---------- Arithmetic ---------- */
+
+// returns a^-1 for a in montgomery form, using the extended euclidean algorithm so that any modulus coprime to a works
+uint64_t gf_inverse(uint64_t a, modulus m) {
+	__int128 prev_r = m.p, r = from_mod(a, m), prev_t = 0, t = 1;
+	while (r != 0) {
+		__int128 q = prev_r / r, next_r = prev_r - q * r, next_t = prev_t - q * t;
+		prev_r = r;
+		r = next_r;
+		prev_t = t;
+		t = next_t;
+	}
+	assert(prev_r == 1);	// a is not invertible
+
+	return to_mod((long long) ((prev_t % m.p + m.p) % m.p), m);
+}
+
+gf_poly *add_gf_poly(gf_poly a, gf_poly b, modulus m) {
+	gf_poly *result = alloc_gf_poly((a.deg > b.deg) ? a.deg : b.deg);
+	int common = (a.deg < b.deg) ? a.deg : b.deg;
+	for (int i=0; i<=common; i++) {
+		result->coefficients[i] = mod_add(a.coefficients[i], b.coefficients[i], m);
+	}
+	for (int i=common+1; i<=a.deg; i++) {
+		result->coefficients[i] = a.coefficients[i];
+	}
+	for (int i=common+1; i<=b.deg; i++) {
+		result->coefficients[i] = b.coefficients[i];
+	}
+	strip_gf_poly(result);
+
+	return result;
+}
+
+gf_poly *subtract_gf_poly(gf_poly a, gf_poly b, modulus m) {
+	gf_poly *result = alloc_gf_poly((a.deg > b.deg) ? a.deg : b.deg);
+	int common = (a.deg < b.deg) ? a.deg : b.deg;
+	for (int i=0; i<=common; i++) {
+		result->coefficients[i] = mod_sub(a.coefficients[i], b.coefficients[i], m);
+	}
+	for (int i=common+1; i<=a.deg; i++) {
+		result->coefficients[i] = a.coefficients[i];
+	}
+	for (int i=common+1; i<=b.deg; i++) {
+		result->coefficients[i] = mod_neg(b.coefficients[i], m);
+	}
+	strip_gf_poly(result);
+
+	return result;
+}
+
+// c must be in montgomery form
+gf_poly *scale_gf_poly(gf_poly a, uint64_t c, modulus m) {
+	gf_poly *result = alloc_gf_poly(a.deg);
+	for (int i=0; i<=a.deg; i++) {
+		result->coefficients[i] = mod_mult(a.coefficients[i], c, m);
+	}
+	strip_gf_poly(result);
+
+	return result;
+}
+
+// runtime: O(deg(a)*deg(b))
+gf_poly *mult_gf_poly(gf_poly a, gf_poly b, modulus m) {
+	if ((a.deg < 0) || (b.deg < 0))
+		return alloc_gf_poly(-1);
+	gf_poly *result = alloc_gf_poly(a.deg + b.deg);
+	for (int i=0; i<=a.deg; i++) {
+		uint64_t a_i = a.coefficients[i];
+		uint64_t *row = result->coefficients + i;
+		for (int j=0; j<=b.deg; j++) {
+			row[j] = mod_add(row[j], mod_mult(a_i, b.coefficients[j], m), m);
+		}
+	}
+	strip_gf_poly(result);
+
+	return result;
+}
+
+// returns the remainder of a divided by b, and sets *quotient to the quotient if it is not NULL
+// the leading coefficient of b must be invertible
+gf_poly *divide_gf_poly(gf_poly a, gf_poly b, modulus m, gf_poly **quotient) {
+	assert(b.deg >= 0);	// cannot divide by 0
+	gf_poly *remainder = copy_gf_poly(a);
+	gf_poly *result = alloc_gf_poly((a.deg >= b.deg) ? a.deg - b.deg : -1);
+	uint64_t lc_inv = gf_inverse(b.coefficients[b.deg], m);
+	for (int i=a.deg-b.deg; i>=0; i--) {
+		uint64_t factor = mod_mult(remainder->coefficients[i + b.deg], lc_inv, m);
+		result->coefficients[i] = factor;
+		uint64_t *row = remainder->coefficients + i;
+		for (int j=0; j<=b.deg; j++) {
+			row[j] = mod_sub(row[j], mod_mult(factor, b.coefficients[j], m), m);
+		}
+	}
+	strip_gf_poly(remainder);
+	if (quotient != NULL) {
+		strip_gf_poly(result);
+		*quotient = result;
+	} else {
+		free_gf_poly(result);
+	}
+
+	return remainder;
+}
+
+gf_poly *monic_gf_poly(gf_poly a, modulus m) {
+	if (a.deg < 0)
+		return alloc_gf_poly(-1);
+	return scale_gf_poly(a, gf_inverse(a.coefficients[a.deg], m), m);
+}
+
+gf_poly *differentiate_gf_poly(gf_poly a, modulus m) {
+	gf_poly *result = alloc_gf_poly(a.deg - 1);
+	for (int i=1; i<=a.deg; i++) {
+		result->coefficients[i - 1] = mod_mult(a.coefficients[i], to_mod(i, m), m);
+	}
+	strip_gf_poly(result);
+
+	return result;
+}
+
+// returns the monic gcd of a and b, and sets *s and *t such that s*a + t*b = gcd if they are not NULL
+// m must be prime
+gf_poly *gcd_gf_poly(gf_poly a, gf_poly b, modulus m, gf_poly **s, gf_poly **t) {
+	gf_poly *prev_r = copy_gf_poly(a), *r = copy_gf_poly(b);
+	gf_poly *prev_s = alloc_gf_poly(0), *cur_s = alloc_gf_poly(-1);
+	gf_poly *prev_t = alloc_gf_poly(-1), *cur_t = alloc_gf_poly(0);
+	prev_s->coefficients[0] = to_mod(1, m);
+	cur_t->coefficients[0] = to_mod(1, m);
+	while (r->deg >= 0) {
+		gf_poly *q;
+		gf_poly *next_r = divide_gf_poly(*prev_r, *r, m, &q);
+		gf_poly *q_s = mult_gf_poly(*q, *cur_s, m), *q_t = mult_gf_poly(*q, *cur_t, m);
+		gf_poly *next_s = subtract_gf_poly(*prev_s, *q_s, m), *next_t = subtract_gf_poly(*prev_t, *q_t, m);
+		free_gf_poly(q);
+		free_gf_poly(q_s);
+		free_gf_poly(q_t);
+		free_gf_poly(prev_r);
+		free_gf_poly(prev_s);
+		free_gf_poly(prev_t);
+		prev_r = r;
+		prev_s = cur_s;
+		prev_t = cur_t;
+		r = next_r;
+		cur_s = next_s;
+		cur_t = next_t;
+	}
+	// normalize so that the gcd is monic
+	uint64_t lc_inv = (prev_r->deg >= 0) ? gf_inverse(prev_r->coefficients[prev_r->deg], m) : to_mod(1, m);
+	gf_poly *result = scale_gf_poly(*prev_r, lc_inv, m);
+	if (s != NULL)
+		*s = scale_gf_poly(*prev_s, lc_inv, m);
+	if (t != NULL)
+		*t = scale_gf_poly(*prev_t, lc_inv, m);
+	free_gf_poly(prev_r);
+	free_gf_poly(prev_s);
+	free_gf_poly(prev_t);
+	free_gf_poly(r);
+	free_gf_poly(cur_s);
+	free_gf_poly(cur_t);
+
+	return result;
+}
+
+/* ---------- Arithmetic mod f ---------- */
+
+static gf_poly *mult_mod_gf_poly(gf_poly a, gf_poly b, gf_poly f, modulus m) {
+	gf_poly *product = mult_gf_poly(a, b, m);
+	gf_poly *result = divide_gf_poly(*product, f, m, NULL);
+	free_gf_poly(product);
+
+	return result;
+}
+
+// returns base^exponent mod f by repeated squaring
+gf_poly *power_mod_gf_poly(gf_poly base, uint64_t exponent, gf_poly f, modulus m) {
+	gf_poly *result = alloc_gf_poly(0);
+	result->coefficients[0] = to_mod(1, m);
+	gf_poly *square = divide_gf_poly(base, f, m, NULL);
+	while (exponent > 0) {
+		if (exponent & 1) {
+			gf_poly *product = mult_mod_gf_poly(*result, *square, f, m);
+			free_gf_poly(result);
+			result = product;
+		}
+		exponent >>= 1;
+		if (exponent > 0) {
+			gf_poly *product = mult_mod_gf_poly(*square, *square, f, m);
+			free_gf_poly(square);
+			square = product;
+		}
+	}
+	free_gf_poly(square);
+	strip_gf_poly(result);
+
+	return result;
+}
+
+// returns g(h) mod f by the baby-step giant-step method of brent and kung
+// with k about sqrt(deg(g)), precomputes h^0, ..., h^k mod f, so that each block of k coefficients of g
+// is a linear combination of them, and the blocks are combined by horner's scheme in h^k
+// runtime: O(sqrt(deg(g)) multiplications mod f, plus O(deg(g)*deg(f)) scalar operations)
+gf_poly *compose_mod_gf_poly(gf_poly g, gf_poly h, gf_poly f, modulus m) {
+	if (g.deg < 0)
+		return alloc_gf_poly(-1);
+	int k = (int) ceil(sqrt((double) g.deg + 1));
+	gf_poly **powers = (gf_poly**) malloc(sizeof(gf_poly*) * (k + 1));
+	powers[0] = alloc_gf_poly(0);
+	powers[0]->coefficients[0] = to_mod(1, m);
+	strip_gf_poly(powers[0]);	// in case f is constant
+	powers[1] = divide_gf_poly(h, f, m, NULL);
+	for (int i=2; i<=k; i++) {
+		powers[i] = mult_mod_gf_poly(*powers[i - 1], *powers[1], f, m);
+	}
+	int num_blocks = (g.deg + k) / k;
+	gf_poly *result = alloc_gf_poly(-1);
+	for (int j=num_blocks-1; j>=0; j--) {
+		// the block sum_i g_(jk+i) h^i, accumulated coefficientwise
+		gf_poly *block = alloc_gf_poly(f.deg - 1);
+		for (int i=0; (i<k) && (j*k + i <= g.deg); i++) {
+			uint64_t c = g.coefficients[j*k + i];
+			if (c == 0)
+				continue;
+			for (int l=0; l<=powers[i]->deg; l++) {
+				block->coefficients[l] = mod_add(block->coefficients[l], mod_mult(c, powers[i]->coefficients[l], m), m);
+			}
+		}
+		strip_gf_poly(block);
+		gf_poly *shifted = mult_mod_gf_poly(*result, *powers[k], f, m);
+		free_gf_poly(result);
+		result = add_gf_poly(*shifted, *block, m);
+		free_gf_poly(shifted);
+		free_gf_poly(block);
+	}
+	for (int i=0; i<=k; i++) {
+		free_gf_poly(powers[i]);
+	}
+	free(powers);
+
+	return result;
+}
+
+// returns x^p mod f
+static gf_poly *frobenius(gf_poly f, modulus m) {
+	gf_poly *x = alloc_gf_poly(1);
+	x->coefficients[1] = to_mod(1, m);
+	gf_poly *result = power_mod_gf_poly(*x, m.p, f, m);
+	free_gf_poly(x);
+
+	return result;
+}
+
+/* ---------- Irreducibility ---------- */
+
+// f of degree n is irreducible exactly when gcd(x^(p^d) - x, f) = 1 for every d <= n/2
+// x^(p^(d+1)) is found from x^(p^d) by composing with x^p
+// m must be prime
+int is_irreducible_gf_poly(gf_poly f, modulus m) {
+	if (f.deg <= 0)
+		return 0;
+	gf_poly *x = alloc_gf_poly(1);
+	x->coefficients[1] = to_mod(1, m);
+	gf_poly *x_p = frobenius(f, m);
+	gf_poly *power = copy_gf_poly(*x_p);
+	int result = 1;
+	for (int d=1; (2*d<=f.deg) && result; d++) {
+		gf_poly *difference = subtract_gf_poly(*power, *x, m);
+		gf_poly *g = gcd_gf_poly(f, *difference, m, NULL, NULL);
+		result = (g->deg == 0);
+		free_gf_poly(difference);
+		free_gf_poly(g);
+		gf_poly *next = compose_mod_gf_poly(*power, *x_p, f, m);
+		free_gf_poly(power);
+		power = next;
+	}
+	free_gf_poly(x);
+	free_gf_poly(x_p);
+	free_gf_poly(power);
+
+	return result;
+}
+
+/* ---------- Berlekamp ---------- */
+
+// returns a basis of the polynomials v of degree below deg(f) with v^p = v mod f, i.e. the berlekamp subalgebra
+// these are the v with sum_i v_i (x^(ip) mod f) = sum_i v_i x^i, so the kernel of Q - I where row i of Q is x^(ip) mod f
+// sets *dim to its dimension, which is the number of irreducible factors of f
+static gf_poly **berlekamp_basis(gf_poly f, modulus m, int *dim) {
+	int n = f.deg;
+	// a[j][i] is the coefficient of x^j in x^(ip) mod f, minus 1 on the diagonal, so that we want a*v = 0
+	uint64_t **a = (uint64_t**) malloc(sizeof(uint64_t*) * n);
+	for (int j=0; j<n; j++) {
+		a[j] = (uint64_t*) calloc(n, sizeof(uint64_t));
+	}
+	gf_poly *x_p = frobenius(f, m);
+	gf_poly *row = alloc_gf_poly(0);
+	row->coefficients[0] = to_mod(1, m);
+	for (int i=0; i<n; i++) {
+		for (int j=0; j<=row->deg; j++) {
+			a[j][i] = row->coefficients[j];
+		}
+		a[i][i] = mod_sub(a[i][i], to_mod(1, m), m);
+		gf_poly *next = mult_mod_gf_poly(*row, *x_p, f, m);
+		free_gf_poly(row);
+		row = next;
+	}
+	free_gf_poly(row);
+	free_gf_poly(x_p);
+	// reduce to reduced row echelon form
+	int *pivot_column = (int*) malloc(sizeof(int) * n);
+	char *is_pivot = (char*) calloc(n, sizeof(char));
+	int rank = 0;
+	for (int col=0; (col<n) && (rank<n); col++) {
+		int pivot = -1;
+		for (int r=rank; (r<n) && (pivot<0); r++) {
+			if (a[r][col] != 0)
+				pivot = r;
+		}
+		if (pivot < 0)
+			continue;
+		uint64_t *swap = a[pivot];
+		a[pivot] = a[rank];
+		a[rank] = swap;
+		uint64_t inverse = gf_inverse(a[rank][col], m);
+		for (int l=0; l<n; l++) {
+			a[rank][l] = mod_mult(a[rank][l], inverse, m);
+		}
+		for (int r=0; r<n; r++) {
+			if ((r == rank) || (a[r][col] == 0))
+				continue;
+			uint64_t factor = a[r][col];
+			for (int l=0; l<n; l++) {
+				a[r][l] = mod_sub(a[r][l], mod_mult(factor, a[rank][l], m), m);
+			}
+		}
+		pivot_column[rank++] = col;
+		is_pivot[col] = 1;
+	}
+	// each free column gives a kernel vector
+	*dim = n - rank;
+	gf_poly **result = (gf_poly**) malloc(sizeof(gf_poly*) * (*dim > 0 ? *dim : 1));
+	int found = 0;
+	for (int col=0; col<n; col++) {
+		if (is_pivot[col])
+			continue;
+		gf_poly *v = alloc_gf_poly(n - 1);
+		v->coefficients[col] = to_mod(1, m);
+		for (int r=0; r<rank; r++) {
+			v->coefficients[pivot_column[r]] = mod_neg(a[r][col], m);
+		}
+		strip_gf_poly(v);
+		result[found++] = v;
+	}
+	for (int j=0; j<n; j++) {
+		free(a[j]);
+	}
+	free(a);
+	free(pivot_column);
+	free(is_pivot);
+
+	return result;
+}
+
+// returns the monic irreducible factors of f, which must be square-free, by berlekamp's algorithm
+// each factor u is split into the gcd(u, v - s) for s in GF(p), for each basis element v of the berlekamp subalgebra
+// runtime: O(deg(f)^3 + p*r*deg(f)^2) for r factors, so only suitable for small p
+gf_poly **berlekamp(gf_poly f, modulus m, int *num_factors) {
+	gf_poly *monic = monic_gf_poly(f, m);
+	int r;
+	gf_poly **basis = berlekamp_basis(*monic, m, &r);
+	gf_poly **result = (gf_poly**) malloc(sizeof(gf_poly*) * (r > 0 ? r : 1));
+	result[0] = monic;
+	*num_factors = 1;
+	for (int b=0; (b<r) && (*num_factors < r); b++) {
+		if (basis[b]->deg <= 0)
+			continue;	// constants do not split anything
+		int count = *num_factors;
+		for (int i=0; (i<count) && (*num_factors < r); i++) {
+			gf_poly *u = result[i];
+			if (u->deg <= 1)
+				continue;
+			// the gcd(u, v - s) for distinct s are coprime with product u, so each is split off in turn
+			for (uint64_t s=0; (s<m.p) && (u->deg > 0) && (*num_factors < r); s++) {
+				gf_poly *shifted = copy_gf_poly(*basis[b]);
+				shifted->coefficients[0] = mod_sub(shifted->coefficients[0], to_mod(s, m), m);
+				gf_poly *g = gcd_gf_poly(*u, *shifted, m, NULL, NULL);
+				free_gf_poly(shifted);
+				if ((g->deg <= 0) || (g->deg == u->deg)) {
+					free_gf_poly(g);
+					continue;
+				}
+				gf_poly *cofactor;
+				free_gf_poly(divide_gf_poly(*u, *g, m, &cofactor));
+				result[(*num_factors)++] = g;
+				free_gf_poly(u);
+				u = result[i] = cofactor;
+			}
+		}
+	}
+	for (int b=0; b<r; b++) {
+		free_gf_poly(basis[b]);
+	}
+	free(basis);
+
+	return result;
+}
+
+/* ---------- Cantor–Zassenhaus ---------- */
+
+// xorshift generator, seeded deterministically so that factoring is reproducible
+static uint64_t next_random(uint64_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+// splits f, a monic product of distinct irreducibles of degree d, into those irreducibles
+// the factors are appended to factors, starting at index *num_factors
+static void equal_degree_factorization(gf_poly f, int d, modulus m, uint64_t *seed, gf_poly **factors, int *num_factors) {
+	if (f.deg == d) {
+		factors[(*num_factors)++] = copy_gf_poly(f);
+		return;
+	}
+	gf_poly *x_p = frobenius(f, m);
+	while (1) {
+		gf_poly *a = alloc_gf_poly(f.deg - 1);
+		for (int i=0; i<f.deg; i++) {
+			a->coefficients[i] = to_mod(next_random(seed) % m.p, m);
+		}
+		strip_gf_poly(a);
+		// a^((p^d - 1)/2) = (a * a^p * ... * a^(p^(d-1)))^((p - 1)/2), where a^(p^(i+1)) = a^(p^i) composed with x^p
+		gf_poly *norm = copy_gf_poly(*a), *conjugate = copy_gf_poly(*a);
+		for (int i=1; i<d; i++) {
+			gf_poly *next = compose_mod_gf_poly(*conjugate, *x_p, f, m);
+			free_gf_poly(conjugate);
+			conjugate = next;
+			gf_poly *product = mult_mod_gf_poly(*norm, *conjugate, f, m);
+			free_gf_poly(norm);
+			norm = product;
+		}
+		gf_poly *b = power_mod_gf_poly(*norm, (m.p - 1) / 2, f, m);
+		gf_poly *one = alloc_gf_poly(0);
+		one->coefficients[0] = to_mod(1, m);
+		gf_poly *b_minus_one = subtract_gf_poly(*b, *one, m);
+		gf_poly *g = gcd_gf_poly(f, *b_minus_one, m, NULL, NULL);
+		free_gf_poly(a);
+		free_gf_poly(norm);
+		free_gf_poly(conjugate);
+		free_gf_poly(b);
+		free_gf_poly(one);
+		free_gf_poly(b_minus_one);
+		if ((g->deg > 0) && (g->deg < f.deg)) {
+			gf_poly *cofactor;
+			free_gf_poly(divide_gf_poly(f, *g, m, &cofactor));
+			equal_degree_factorization(*g, d, m, seed, factors, num_factors);
+			equal_degree_factorization(*cofactor, d, m, seed, factors, num_factors);
+			free_gf_poly(cofactor);
+			free_gf_poly(g);
+			free_gf_poly(x_p);
+			return;
+		}
+		free_gf_poly(g);
+	}
+}
+
+// returns parts[0..deg(f)], where parts[d] is the monic product of the irreducible factors of f of degree d
+// f must be square-free with positive degree, and m prime
+// the powers x^(p^d) are stepped by modular composition with x^p
+gf_poly **distinct_degree_factorization(gf_poly f, modulus m) {
+	gf_poly **parts = (gf_poly**) malloc(sizeof(gf_poly*) * (f.deg + 1));
+	for (int d=0; d<=f.deg; d++) {
+		parts[d] = alloc_gf_poly(0);
+		parts[d]->coefficients[0] = to_mod(1, m);
+	}
+	gf_poly *remaining = monic_gf_poly(f, m);
+	gf_poly *x = alloc_gf_poly(1);
+	x->coefficients[1] = to_mod(1, m);
+	gf_poly *x_p = frobenius(*remaining, m);
+	gf_poly *power = copy_gf_poly(*x_p);	// x^(p^d) mod remaining
+	for (int d=1; 2*d<=remaining->deg; d++) {
+		// the product of the irreducible factors of degree d is gcd(x^(p^d) - x, remaining)
+		gf_poly *difference = subtract_gf_poly(*power, *x, m);
+		gf_poly *part = gcd_gf_poly(*remaining, *difference, m, NULL, NULL);
+		free_gf_poly(difference);
+		if (part->deg > 0) {
+			gf_poly *quotient;
+			free_gf_poly(divide_gf_poly(*remaining, *part, m, &quotient));
+			free_gf_poly(remaining);
+			remaining = quotient;
+			gf_poly *reduced_power = divide_gf_poly(*power, *remaining, m, NULL);
+			gf_poly *reduced_x_p = divide_gf_poly(*x_p, *remaining, m, NULL);
+			free_gf_poly(power);
+			free_gf_poly(x_p);
+			power = reduced_power;
+			x_p = reduced_x_p;
+		}
+		free_gf_poly(parts[d]);
+		parts[d] = part;
+		if (2*(d + 1) <= remaining->deg) {
+			gf_poly *next = compose_mod_gf_poly(*power, *x_p, *remaining, m);
+			free_gf_poly(power);
+			power = next;
+		}
+	}
+	// whatever is left is irreducible
+	if (remaining->deg > 0) {
+		free_gf_poly(parts[remaining->deg]);
+		parts[remaining->deg] = remaining;
+	} else {
+		free_gf_poly(remaining);
+	}
+	free_gf_poly(x);
+	free_gf_poly(x_p);
+	free_gf_poly(power);
+
+	return parts;
+}
+
+// returns the monic irreducible factors of f, which must be square-free, by the algorithm of cantor and zassenhaus
+// distinct-degree factorization splits f by the degrees of its factors, and each part is split by equal-degree factorization
+// p must be odd
+gf_poly **cantor_zassenhaus(gf_poly f, modulus m, int *num_factors) {
+	gf_poly **result = (gf_poly**) malloc(sizeof(gf_poly*) * (f.deg > 0 ? f.deg : 1));
+	*num_factors = 0;
+	uint64_t seed = 0x9e3779b97f4a7c15ULL;
+	gf_poly **parts = distinct_degree_factorization(f, m);
+	for (int d=1; d<=f.deg; d++) {
+		if (parts[d]->deg > 0)
+			equal_degree_factorization(*parts[d], d, m, &seed, result, num_factors);
+	}
+	for (int d=0; d<=f.deg; d++) {
+		free_gf_poly(parts[d]);
+	}
+	free(parts);
+
+	return result;
+}
+
+// returns the monic irreducible factors of f, which must be square-free with positive degree
+// uses berlekamp's algorithm for small primes, and cantor–zassenhaus otherwise
+gf_poly **factor_gf_poly(gf_poly f, modulus m, int *num_factors) {
+	if (m.p < BERLEKAMP_PRIME_BOUND)
+		return berlekamp(f, m, num_factors);
+	return cantor_zassenhaus(f, m, num_factors);
+}
+
+/* ---------- Input / Output ---------- */
+
+// prints the residues of the coefficients, from highest to lowest degree
+void print_gf_poly(gf_poly f, modulus m) {
+	if (f.deg < 0) {
+		printf("0\n");
+		return;
+	}
+	int first = 1;
+	for (int i=f.deg; i>=0; i--) {
+		uint64_t c = from_mod(f.coefficients[i], m);
+		if ((c == 0) && ((i > 0) || !first))
+			continue;
+		if (!first)
+			printf(" + ");
+		if ((c != 1) || (i == 0))
+			printf("%llu", (unsigned long long) c);
+		if (i > 0)
+			printf("x^%d", i);
+		first = 0;
+	}
+	printf("\n");
+}
+
+/* ---------- Testing ---------- */
+// to test, run "make test gf_poly"
+
+#ifdef TEST_GF_POLY
+
+// returns the factors sorted by their lowest coefficients, so that output does not depend on the order they were found in
+static int compare_factors(const void *a, const void *b) {
+	gf_poly *f = *(gf_poly**) a, *g = *(gf_poly**) b;
+	if (f->deg != g->deg)
+		return f->deg - g->deg;
+	for (int i=f->deg; i>=0; i--) {
+		if (f->coefficients[i] != g->coefficients[i])
+			return (f->coefficients[i] < g->coefficients[i]) ? -1 : 1;
+	}
+	return 0;
+}
+
+static void print_factors(gf_poly **factors, int num_factors, modulus m) {
+	// sort by residues rather than montgomery forms
+	for (int i=0; i<num_factors; i++) {
+		for (int j=0; j<=factors[i]->deg; j++) {
+			factors[i]->coefficients[j] = from_mod(factors[i]->coefficients[j], m);
+		}
+	}
+	qsort(factors, num_factors, sizeof(gf_poly*), compare_factors);
+	for (int i=0; i<num_factors; i++) {
+		for (int j=0; j<=factors[i]->deg; j++) {
+			factors[i]->coefficients[j] = to_mod(factors[i]->coefficients[j], m);
+		}
+		print_gf_poly(*factors[i], m);
+	}
+}
+
+/* should output:
+ * divide_gf_poly: 1
+ * compose_mod_gf_poly: 1
+ * is_irreducible_gf_poly: 1, 0
+ * berlekamp: 2 factors
+ * x^2 + 5x^1 + 1
+ * x^2 + 8x^1 + 1
+ * cantor_zassenhaus: 2 factors
+ * x^2 + 5x^1 + 1
+ * x^2 + 8x^1 + 1
+ * cantor_zassenhaus: 3 factors
+ * x^1 + 2596336226001320794
+ * x^1 + 6627035810853454989
+ * x^2 + 1 */
+void test_gf_poly() {
+	modulus m = init_modulus(13);
+	// (x^3 + 2x + 5) * (x^2 + 7) / (x^2 + 7)
+	int a_coefficients[] = {1, 0, 2, 5}, b_coefficients[] = {1, 0, 7};
+	polynomial a = {3, a_coefficients}, b = {2, b_coefficients};
+	gf_poly *a_mod = polynomial_to_gf_poly(a, m), *b_mod = polynomial_to_gf_poly(b, m);
+	gf_poly *product = mult_gf_poly(*a_mod, *b_mod, m), *quotient;
+	gf_poly *remainder = divide_gf_poly(*product, *b_mod, m, &quotient);
+	int agree = (remainder->deg < 0) && (quotient->deg == a_mod->deg);
+	for (int i=0; agree && (i<=a_mod->deg); i++) {
+		agree = (quotient->coefficients[i] == a_mod->coefficients[i]);
+	}
+	printf("divide_gf_poly: %d\n", agree);
+	// a(b) mod x^4 + 1 by composition and by horner's scheme
+	int f_coefficients[] = {1, 0, 0, 0, 1};
+	polynomial f = {4, f_coefficients};
+	gf_poly *f_mod = polynomial_to_gf_poly(f, m);
+	gf_poly *composed = compose_mod_gf_poly(*a_mod, *b_mod, *f_mod, m);
+	gf_poly *horner = alloc_gf_poly(-1);
+	for (int i=a_mod->deg; i>=0; i--) {
+		gf_poly *shifted = mult_gf_poly(*horner, *b_mod, m);
+		gf_poly *constant = alloc_gf_poly(0);
+		constant->coefficients[0] = a_mod->coefficients[i];
+		strip_gf_poly(constant);
+		gf_poly *sum = add_gf_poly(*shifted, *constant, m);
+		free_gf_poly(horner);
+		horner = divide_gf_poly(*sum, *f_mod, m, NULL);
+		free_gf_poly(shifted);
+		free_gf_poly(constant);
+		free_gf_poly(sum);
+	}
+	agree = (composed->deg == horner->deg);
+	for (int i=0; agree && (i<=horner->deg); i++) {
+		agree = (composed->coefficients[i] == horner->coefficients[i]);
+	}
+	printf("compose_mod_gf_poly: %d\n", agree);
+	// x^2 + 1 is irreducible mod 3 but not mod 5
+	int c_coefficients[] = {1, 0, 1};
+	polynomial c = {2, c_coefficients};
+	printf("is_irreducible_gf_poly: %d, %d\n", is_irreducible_gf_poly(*polynomial_to_gf_poly(c, init_modulus(3)), init_modulus(3)),
+			is_irreducible_gf_poly(*polynomial_to_gf_poly(c, init_modulus(5)), init_modulus(5)));
+	// x^4 - 10x^2 + 1 splits into quadratics mod 13
+	int d_coefficients[] = {1, 0, -10, 0, 1};
+	polynomial d = {4, d_coefficients};
+	gf_poly *d_mod = polynomial_to_gf_poly(d, m);
+	int num_factors;
+	gf_poly **factors = berlekamp(*d_mod, m, &num_factors);
+	printf("berlekamp: %d factors\n", num_factors);
+	print_factors(factors, num_factors, m);
+	factors = cantor_zassenhaus(*d_mod, m, &num_factors);
+	printf("cantor_zassenhaus: %d factors\n", num_factors);
+	print_factors(factors, num_factors, m);
+	// x^4 + 11x^2 + 10 = (x^2 + 1)(x^2 + 10), where -10 is a square modulo the first table prime
+	modulus large = modular_prime(0);
+	int e_coefficients[] = {1, 0, 11, 0, 10};
+	polynomial e = {4, e_coefficients};
+	factors = factor_gf_poly(*polynomial_to_gf_poly(e, large), large, &num_factors);
+	printf("cantor_zassenhaus: %d factors\n", num_factors);
+	print_factors(factors, num_factors, large);
+}
+
+int main(int argc, char **argv) {
+	test_gf_poly();
+	exit(0);
+}
+
+#endif
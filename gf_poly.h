@@ -0,0 +1,65 @@
+// gf_poly.h
+// polynomials over GF(p) for word-size primes p, with coefficients in montgomery form
+
+#ifndef GF_POLY_H
+#define GF_POLY_H
+
+#include "polynomial.h"
+#include "modular.h"
+#include <stdint.h>
+
+// Berlekamp's algorithm is used below this prime, and Cantor–Zassenhaus above it
+#define BERLEKAMP_PRIME_BOUND 64
+
+// the coefficient array is aligned and padded, so that coefficientwise loops vectorize
+// arithmetic other than gcds, inverses and factoring also works modulo odd prime powers, as hensel lifting needs
+typedef struct gf_poly {
+	int deg;				// degree of the zero polynomial is -1
+	uint64_t *coefficients;	// from lowest to highest degree, unlike polynomial
+} gf_poly;
+
+gf_poly *alloc_gf_poly(int);
+
+void free_gf_poly(gf_poly*);
+
+gf_poly *copy_gf_poly(gf_poly);
+
+void strip_gf_poly(gf_poly*);
+
+gf_poly *polynomial_to_gf_poly(polynomial, modulus);
+
+uint64_t gf_inverse(uint64_t, modulus);
+
+gf_poly *add_gf_poly(gf_poly, gf_poly, modulus);
+
+gf_poly *subtract_gf_poly(gf_poly, gf_poly, modulus);
+
+gf_poly *scale_gf_poly(gf_poly, uint64_t, modulus);
+
+gf_poly *mult_gf_poly(gf_poly, gf_poly, modulus);
+
+gf_poly *divide_gf_poly(gf_poly, gf_poly, modulus, gf_poly **);
+
+gf_poly *monic_gf_poly(gf_poly, modulus);
+
+gf_poly *differentiate_gf_poly(gf_poly, modulus);
+
+gf_poly *gcd_gf_poly(gf_poly, gf_poly, modulus, gf_poly **, gf_poly **);
+
+gf_poly *power_mod_gf_poly(gf_poly, uint64_t, gf_poly, modulus);
+
+gf_poly *compose_mod_gf_poly(gf_poly, gf_poly, gf_poly, modulus);
+
+int is_irreducible_gf_poly(gf_poly, modulus);
+
+gf_poly **distinct_degree_factorization(gf_poly, modulus);
+
+gf_poly **berlekamp(gf_poly, modulus, int *);
+
+gf_poly **cantor_zassenhaus(gf_poly, modulus, int *);
+
+gf_poly **factor_gf_poly(gf_poly, modulus, int *);
+
+void print_gf_poly(gf_poly, modulus);
+
+#endif
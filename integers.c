@@ -5,9 +5,8 @@
 #include "integers.h"
 #include <stdlib.h>
 #include <stdio.h>
-#include <assert.h>
 #include <math.h>
-#define CONT_FRAC_LEN 15
+#include <limits.h>
 
 int gcd(int a, int b) {
 	if (b == 0)
@@ -21,50 +20,94 @@ int lcm(int a, int b) {
 	return (a * b) / gcd(a, b);
 }
 
-// helper function for denom
-static matrix_entry eval_continued_fraction(int *fraction, int length) {
-	if (length == 1)
-		return (matrix_entry) fraction[0];
-	return fraction[0] + 1 / eval_continued_fraction(fraction + 1, length - 1);
+// returns the gcd of a and b, with the sign convention of gcd
+long long gcd_ll(long long a, long long b) {
+	while (b != 0) {
+		long long r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
 }
 
-// returns the denominator of d as a fraction
-// computes successive continued fraction approximations until one is close enough
-int denom(matrix_entry d) {
-/*	if (d < 0)	// handle negative d
-		return denom(-d);
-*/	// initialize the continued fraction
-	int length = 0, max_length = CONT_FRAC_LEN;
-	int *fraction = (int*) malloc(sizeof(int) * max_length);
-	fraction[0] = (int) floor(d);
-	matrix_entry next_term_unrounded = 1 / (d - fraction[0]);
-	// increase the precesion of the continued fraction
-	while (fabsl(d - eval_continued_fraction(fraction, ++length)) > MATRIX_IND_ERR) {
-		fraction[length] = (int) next_term_unrounded;
-		next_term_unrounded = 1.0 / (next_term_unrounded - fraction[length]);
-		// if necessary, allocate more memory for the continued fraction
-		if (length == max_length) {
-			max_length *= 2;
-			fraction = realloc(fraction, sizeof(int) * max_length);
-		}
+// sets *result to the lcm of a and b
+// returns 0 if the lcm does not fit in a long long, and 1 otherwise
+int lcm_ll(long long a, long long b, long long *result) {
+	if (a == 0) {
+		*result = 0;
+		return 1;
 	}
-	// get the denominator of the continued fraction
-	int result;
-	if (length == 1) {
-		result = 1;
-	} else {	// uses the fundamental recurrence formulas
-		int *denoms = (int*) malloc(sizeof(int) * 2);
-		denoms[0] = 1;
-		denoms[1] = fraction[1];
-		for (int i=2; i<length; i++) {
-			denoms[i % 2] = fraction[i] * denoms[(i - 1) % 2] + denoms[(i - 2) % 2];
+	return !__builtin_mul_overflow(a / gcd_ll(a, b), b, result);
+}
+
+/* ---------- Rational Reconstruction ---------- */
+
+// returns the denominator of the first continued fraction convergent h/k of d with |d - h/k| <= tolerance
+// the convergents are built by the recurrence h_i = a_i*h_(i-1) + h_(i-2), and likewise for k
+// the bound is checked on the convergent itself, so the returned fraction is certified to be within tolerance
+// sets *numerator to h, and returns 0 if k would exceed max_denom
+long long rational_approx(matrix_entry d, matrix_entry tolerance, long long max_denom, long long *numerator) {
+	long long h = 1, prev_h = 0, k = 0, prev_k = 1;
+	matrix_entry remainder = d;
+	while (1) {
+		// the next partial quotient must fit in a long long
+		if ((remainder >= 0x1p62Q) || (remainder <= -0x1p62Q))
+			return 0;
+		long long a = (long long) remainder;
+		if (a > remainder)	// round towards negative infinity
+			a--;
+		long long next_h, next_k;
+		if (__builtin_mul_overflow(a, h, &next_h) || __builtin_add_overflow(next_h, prev_h, &next_h)
+				|| __builtin_mul_overflow(a, k, &next_k) || __builtin_add_overflow(next_k, prev_k, &next_k)
+				|| (next_k > max_denom))
+			return 0;
+		prev_h = h;
+		prev_k = k;
+		h = next_h;
+		k = next_k;
+		matrix_entry error = d - (matrix_entry) h / k;
+		if ((error <= tolerance) && (error >= -tolerance)) {
+			*numerator = h;
+			return k;
 		}
-		result = denoms[(length - 1) % 2];
-		free(denoms);
+		remainder = 1 / (remainder - a);
+	}
+}
+
+// returns the denominator of d as a fraction
+// returns 0 if d is too large for its convergents to fit in a long long before one is within MATRIX_IND_ERR
+long long denom(matrix_entry d) {
+	long long numerator;
+	return rational_approx(d, MATRIX_IND_ERR, LLONG_MAX, &numerator);
+}
+
+// finds n/d congruent to u mod m with |n|, d <= sqrt(m/2), using wang's algorithm
+// runs the extended euclidean algorithm on m and u until the remainder is at most the bound
+// returns 0 if no such fraction exists, and 1 otherwise
+// runtime: O(log(m))
+int rational_reconstruct(uint64_t u, uint64_t m, long long *numerator, long long *denominator) {
+	uint64_t bound = (uint64_t) sqrtl((long double) (m / 2));
+	while ((unsigned __int128) (bound + 1) * (bound + 1) <= m / 2) {
+		bound++;
+	}
+	while ((unsigned __int128) bound * bound > m / 2) {
+		bound--;
+	}
+	// invariant: r_i = t_i*u mod m
+	__int128 prev_r = m, r = u % m, prev_t = 0, t = 1;
+	while (r > bound) {
+		__int128 q = prev_r / r, next_r = prev_r - q * r, next_t = prev_t - q * t;
+		prev_r = r;
+		r = next_r;
+		prev_t = t;
+		t = next_t;
 	}
-	free(fraction);
-	
-	return result;
+	if ((t > bound) || (-t > bound) || (gcd_ll((long long) r, (long long) t) != 1 && gcd_ll((long long) r, (long long) t) != -1))
+		return 0;
+	*numerator = (long long) ((t < 0) ? -r : r);
+	*denominator = (long long) ((t < 0) ? -t : t);
+
+	return 1;
 }
 
 // to test, run "make test integers"
@@ -80,15 +123,45 @@ void test_lcm() {
 	printf("lcm: %d, %d\n", lcm(55, 4), lcm(-9, 12));
 }
 
-// should output 187, 781
+// should output 187, 781, 0
 void test_denom() {
-	printf("denom: %d, %d\n", denom(3.0 / 561.0), denom(-5571.0 / 781.0));
+	printf("denom: %lld, %lld, %lld\n", denom(3.0 / 561.0), denom(-5571.0 / 781.0), denom(1e20Q));
+}
+
+// should output 1, 6000000000000000000, 0
+void test_lcm_ll() {
+	long long result;
+	int success = lcm_ll(2000000000000000000LL, 3, &result);
+	printf("lcm_ll: %d, %lld, ", success, result);
+	printf("%d\n", lcm_ll(3000000000000000000LL, 7, &result));
+}
+
+// should output 355/113, 0
+void test_rational_approx() {
+	long long numerator, denominator = rational_approx(3.14159265358979323846Q, 1e-6Q, 1000, &numerator);
+	printf("rational_approx: %lld/%lld, ", numerator, denominator);
+	printf("%lld\n", rational_approx(3.14159265358979323846Q, 1e-12Q, 1000, &numerator));
+}
+
+// should output -22/7, 0
+void test_rational_reconstruct() {
+	long long numerator, denominator;
+	uint64_t m = 1000003;
+	// -22/7 mod m, where 7^-1 = 714288 mod m
+	// 999 is too large to be a numerator, and has no small fraction congruent to it
+	uint64_t u = (m - 22) * 714288 % m;
+	rational_reconstruct(u, m, &numerator, &denominator);
+	printf("rational_reconstruct: %lld/%lld, ", numerator, denominator);
+	printf("%d\n", rational_reconstruct(999, m, &numerator, &denominator));
 }
 
 int main(int argc, char **argv) {
 	test_gcd();
 	test_lcm();
 	test_denom();
+	test_lcm_ll();
+	test_rational_approx();
+	test_rational_reconstruct();
 	exit(0);
 }
 
@@ -4,11 +4,20 @@
 #define INTEGERS_H
 
 #include "precision.h"
+#include <stdint.h>
 
 int gcd(int, int);
 
 int lcm(int, int);
 
-int denom(matrix_entry);
+long long gcd_ll(long long, long long);
+
+int lcm_ll(long long, long long, long long *);
+
+long long rational_approx(matrix_entry, matrix_entry, long long, long long *);
+
+long long denom(matrix_entry);
+
+int rational_reconstruct(uint64_t, uint64_t, long long *, long long *);
 
 #endif
@@ -6,43 +6,271 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#include <limits.h>
+#include <pthread.h>
 
-// returns the matrix used to interpolate evaluation at 0,...,degree
-// runtime: O(degree^3)
-static matrix *interpolation_matrix(int degree) {
-	matrix *result_inv = alloc_matrix(degree + 1, degree + 1);
+// the default memory limit of the operator cache
+#define OPERATOR_CACHE_BYTES (64 << 20)
+
+/* ---------- Vandermonde Systems ---------- */
+
+// returns the vandermonde matrix of the given nodes
+// multiplying it by the coefficients of a polynomial gives its values at those points
+static matrix *vandermonde_matrix(vector nodes, int degree) {
+	matrix *result = alloc_matrix(degree + 1, degree + 1);
 	for (int i=0; i<=degree; i++) {
+		matrix_entry power = 1;
 		for (int j=0; j<=degree; j++) {
-			result_inv->entries[i][j] = pow(i, j);
+			result->entries[i][j] = power;
+			power *= nodes[i];
 		}
 	}
-	
-	matrix *result = invert_matrix(*result_inv);
-	free_matrix(result_inv);
-	
+
 	return result;
 }
 
-// returns the polynomial which passes through vals at 0,...,degree
-// runtime: O(degree^4)
-polynomial *interpolate(vector vals, int degree) {
+// returns the polynomial with coefficients fractional_coeffs, from lowest to highest degree, with denominators cleared
+// error bounds the absolute error of each of fractional_coeffs, which must be within the tolerance denom allows,
+// and small enough that the coefficients times the common denominator still round to the right integers
+// returns NULL if error is too large, a denominator cannot be found, or the common denominator or a cleared coefficient overflows
+static polynomial *clear_denominators(vector fractional_coeffs, int degree, matrix_entry error) {
+	if (error > MATRIX_IND_ERR)
+		return NULL;
+	long long total_denom = 1;
+	for (int i=0; i<=degree; i++) {
+		long long coeff_denom = denom(fractional_coeffs[i]);
+		if ((coeff_denom == 0) || !lcm_ll(total_denom, coeff_denom, &total_denom))
+			return NULL;
+	}
+	if (total_denom * error >= 0.5)
+		return NULL;
 	polynomial *result = alloc_polynomial(degree);
-	matrix *interp_matrix = interpolation_matrix(degree);
-	vector fractional_coeffs = matrix_eval(*interp_matrix, vals);
-	// clear the denominators in fractional_coeffs and reverse entries
-	int total_denom = denom(fractional_coeffs[0]);
-	for (int i=1; i<=degree; i++) {
-		total_denom = lcm(total_denom, denom(fractional_coeffs[i]));
+	for (int i=0; i<=degree; i++) {
+		double coefficient = round(total_denom * fractional_coeffs[degree - i]);
+		if ((coefficient > INT_MAX) || (coefficient < INT_MIN)) {
+			free_polynomial(result);
+			return NULL;
+		}
+		result->coefficients[i] = (int) coefficient;
 	}
+	// remove leading zeros from result
+	strip_leading_zeros(result);
+
+	return result;
+}
+
+// returns the polynomial which passes through vals at the given nodes, with denominators cleared
+// solves the vandermonde system directly rather than forming its inverse
+// returns NULL if the cleared coefficients do not fit in an int, or the system is too ill-conditioned to round them reliably
+// runtime: O(degree^3)
+polynomial *interpolate_nodes(vector nodes, vector vals, int degree) {
+	matrix *vandermonde = vandermonde_matrix(nodes, degree);
+	matrix_entry error_bound;
+	vector fractional_coeffs = refined_solve(*vandermonde, vals, &error_bound);
+	// error_bound is relative to the largest coefficient
+	matrix_entry largest = 0;
 	for (int i=0; i<=degree; i++) {
-		result->coefficients[i] = (int) round(total_denom * fractional_coeffs[degree - i]);
+		if (fabs(fractional_coeffs[i]) > largest)
+			largest = fabs(fractional_coeffs[i]);
 	}
+	polynomial *result = clear_denominators(fractional_coeffs, degree, error_bound * largest);
 	// free intermediates
-	free_matrix(interp_matrix);
+	free_matrix(vandermonde);
 	free(fractional_coeffs);
-	// remove leading zeros from result
-	strip_leading_zeros(result);
-	
+
+	return result;
+}
+
+/* ---------- Operator Cache ---------- */
+
+// the inverse of the vandermonde matrix of 0,...,degree, shared between calls
+typedef struct cached_operator {
+	int degree;
+	matrix *inverse;
+	size_t bytes;
+	int refcount;				// number of callers currently using the operator
+	unsigned long last_used;	// value of cache_clock when last acquired
+	struct cached_operator *next;
+} cached_operator;
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static cached_operator *cache_head = NULL;
+static size_t cache_limit = OPERATOR_CACHE_BYTES;
+static unsigned long cache_clock = 0;
+static interpolation_cache_stats cache_stats;
+
+// removes least recently used operators which are not in use until the cache fits in its limit
+// must be called with cache_lock held
+static void evict_operators() {
+	while (cache_stats.bytes > cache_limit) {
+		cached_operator **victim = NULL;
+		for (cached_operator **op=&cache_head; *op!=NULL; op=&((*op)->next)) {
+			if (((*op)->refcount == 0) && ((victim == NULL) || ((*op)->last_used < (*victim)->last_used)))
+				victim = op;
+		}
+		if (victim == NULL)
+			return;	// everything left is in use
+		cached_operator *evicted = *victim;
+		*victim = evicted->next;
+		cache_stats.bytes -= evicted->bytes;
+		cache_stats.entries--;
+		cache_stats.evictions++;
+		free_matrix(evicted->inverse);
+		free(evicted);
+	}
+}
+
+// returns the operator for the given degree, computing it if it is not cached
+// the operator must be released once the caller is done with it
+static cached_operator *acquire_operator(int degree) {
+	pthread_mutex_lock(&cache_lock);
+	for (cached_operator *op=cache_head; op!=NULL; op=op->next) {
+		if (op->degree == degree) {
+			op->refcount++;
+			op->last_used = ++cache_clock;
+			cache_stats.hits++;
+			pthread_mutex_unlock(&cache_lock);
+			return op;
+		}
+	}
+	cache_stats.misses++;
+	pthread_mutex_unlock(&cache_lock);
+
+	// invert without holding the lock, so other degrees can be served meanwhile
+	vector nodes = (vector) malloc(sizeof(matrix_entry) * (degree + 1));
+	for (int i=0; i<=degree; i++) {
+		nodes[i] = i;
+	}
+	matrix *vandermonde = vandermonde_matrix(nodes, degree);
+	cached_operator *result = (cached_operator*) malloc(sizeof(cached_operator));
+	result->degree = degree;
+	result->inverse = invert_matrix(*vandermonde);
+	result->bytes = sizeof(cached_operator) + sizeof(matrix_entry) * result->inverse->m * result->inverse->stride;
+	result->refcount = 1;
+	free_matrix(vandermonde);
+	free(nodes);
+
+	pthread_mutex_lock(&cache_lock);
+	// another thread may have computed the same operator in the meantime
+	for (cached_operator *op=cache_head; op!=NULL; op=op->next) {
+		if (op->degree == degree) {
+			op->refcount++;
+			op->last_used = ++cache_clock;
+			pthread_mutex_unlock(&cache_lock);
+			free_matrix(result->inverse);
+			free(result);
+			return op;
+		}
+	}
+	result->last_used = ++cache_clock;
+	result->next = cache_head;
+	cache_head = result;
+	cache_stats.bytes += result->bytes;
+	cache_stats.entries++;
+	evict_operators();
+	pthread_mutex_unlock(&cache_lock);
+
+	return result;
+}
+
+static void release_operator(cached_operator *op) {
+	pthread_mutex_lock(&cache_lock);
+	op->refcount--;
+	evict_operators();
+	pthread_mutex_unlock(&cache_lock);
+}
+
+// returns the number of hits, misses and evictions of the operator cache, and its current size
+interpolation_cache_stats get_interpolation_cache_stats() {
+	pthread_mutex_lock(&cache_lock);
+	interpolation_cache_stats result = cache_stats;
+	pthread_mutex_unlock(&cache_lock);
+
+	return result;
+}
+
+// sets the memory limit of the operator cache in bytes, evicting operators if necessary
+void set_interpolation_cache_limit(size_t bytes) {
+	pthread_mutex_lock(&cache_lock);
+	cache_limit = bytes;
+	evict_operators();
+	pthread_mutex_unlock(&cache_lock);
+}
+
+/* ---------- Nodes 0,...,degree ---------- */
+
+// divided differences of an integer polynomial at consecutive integers are integers
+// so the newton coefficients f[0,...,k] are found exactly, dividing by k at level k
+// returns 0 if a value or division is not integral, or an intermediate value overflows
+// runtime: O(degree^2)
+static int newton_coefficients(vector vals, int degree, __int128 *coeffs) {
+	__int128 *diffs = (__int128*) malloc(sizeof(__int128) * (degree + 1));
+	int success = 1;
+	for (int i=0; (i<=degree) && success; i++) {
+		success = (vals[i] < 1e36Q) && (vals[i] > -1e36Q) && ((matrix_entry) (__int128) vals[i] == vals[i]);
+		if (success)
+			diffs[i] = (__int128) vals[i];
+	}
+	// after level k, diffs[i] holds f[i,...,i+k]
+	for (int k=0; (k<=degree) && success; k++) {
+		coeffs[k] = diffs[0];
+		for (int i=0; (i<degree-k) && success; i++) {
+			__int128 difference;
+			success = !__builtin_sub_overflow(diffs[i + 1], diffs[i], &difference) && (difference % (k + 1) == 0);
+			diffs[i] = difference / (k + 1);
+		}
+	}
+	free(diffs);
+
+	return success;
+}
+
+// returns the polynomial which passes through vals at 0,...,degree
+// the newton form is converted to the monomial basis by nested multiplication, all in exact integer arithmetic
+// if the polynomial does not have integer coefficients, falls back to the cached inverse of the vandermonde matrix
+// returns NULL if the coefficients, with denominators cleared, do not fit in an int
+// runtime: O(degree^2), plus O(degree^3) the first time the fallback is used for a degree
+polynomial *interpolate(vector vals, int degree) {
+	__int128 *newton = (__int128*) malloc(sizeof(__int128) * (degree + 1));
+	// coefficients from lowest to highest degree
+	__int128 *monomial = (__int128*) calloc(degree + 1, sizeof(__int128));
+	int success = newton_coefficients(vals, degree, newton);
+	// p = newton[0] + x*(newton[1] + (x - 1)*(newton[2] + ...))
+	// after processing k, monomial holds newton[k] + (x - k)*(newton[k+1] + ...), of degree degree-k
+	if (success)
+		monomial[0] = newton[degree];
+	for (int k=degree-1; (k>=0) && success; k--) {
+		// multiply by x - k, then add newton[k]
+		for (int i=degree-k; (i>=0) && success; i--) {
+			__int128 shifted = (i > 0) ? monomial[i - 1] : 0, scaled;
+			success = !__builtin_mul_overflow(monomial[i], (__int128) k, &scaled)
+					&& !__builtin_sub_overflow(shifted, scaled, &monomial[i]);
+		}
+		success = success && !__builtin_add_overflow(monomial[0], newton[k], &monomial[0]);
+	}
+	for (int i=0; (i<=degree) && success; i++) {
+		success = (monomial[i] >= INT_MIN) && (monomial[i] <= INT_MAX);
+	}
+	polynomial *result = NULL;
+	if (success) {
+		result = alloc_polynomial(degree);
+		for (int i=0; i<=degree; i++) {
+			result->coefficients[i] = (int) monomial[degree - i];
+		}
+		strip_leading_zeros(result);
+	}
+	free(newton);
+	free(monomial);
+	if (result != NULL)
+		return result;
+
+	cached_operator *op = acquire_operator(degree);
+	vector fractional_coeffs = matrix_eval(*(op->inverse), vals);
+	release_operator(op);
+	// the cached inverse of the vandermonde matrix of small integer nodes is applied as if exact
+	result = clear_denominators(fractional_coeffs, degree, 0);
+	free(fractional_coeffs);
+
 	return result;
 }
 
@@ -51,12 +279,51 @@ polynomial *interpolate(vector vals, int degree) {
 
 #ifdef TEST_INTERPOLATE
 
-// should output whatever (x-1)(x-2)(x-3)(x-4) is
+/* should output:
+ * interpolate: x^4 - 10x^3 + 35x^2 - 50x^1 + 24
+ * interpolate: x^2 - x^1
+ * interpolate_nodes: 2x^2 - 1
+ * interpolate: x^2 + x^1
+ * cache: 1 hits, 1 misses, 1 entries
+ * cache: 1 evictions, 0 entries
+ * interpolate: 1 */
 void test_interpolate() {
+	// (x-1)(x-2)(x-3)(x-4)
 	vector vals = (vector) calloc(5, sizeof(matrix_entry));
 	vals[0] = 24;
 	printf("interpolate: ");
 	print_polynomial(*interpolate(vals, 4));
+	// x(x-1)/2 does not have integer coefficients, so its denominator is cleared by the fallback
+	for (int i=0; i<=2; i++) {
+		vals[i] = i * (i - 1) / 2;
+	}
+	printf("interpolate: ");
+	print_polynomial(*interpolate(vals, 2));
+	// x^2 - 1/2 at -1, 1/2, 2
+	vector nodes = (vector) malloc(sizeof(matrix_entry) * 3);
+	nodes[0] = -1;
+	nodes[1] = 0.5Q;
+	nodes[2] = 2;
+	for (int i=0; i<=2; i++) {
+		vals[i] = nodes[i] * nodes[i] - 0.5Q;
+	}
+	printf("interpolate_nodes: ");
+	print_polynomial(*interpolate_nodes(nodes, vals, 2));
+	// the fallback above computed the operator for degree 2, which is reused here
+	for (int i=0; i<=2; i++) {
+		vals[i] = i * (i + 1) / 2;
+	}
+	printf("interpolate: ");
+	print_polynomial(*interpolate(vals, 2));
+	interpolation_cache_stats stats = get_interpolation_cache_stats();
+	printf("cache: %lu hits, %lu misses, %d entries\n", stats.hits, stats.misses, stats.entries);
+	set_interpolation_cache_limit(0);
+	stats = get_interpolation_cache_stats();
+	printf("cache: %lu evictions, %d entries\n", stats.evictions, stats.entries);
+	// 10^12 x does not fit in an int, which is reported rather than rounded into garbage
+	vals[0] = 0;
+	vals[1] = 1e12Q;
+	printf("interpolate: %d\n", interpolate(vals, 1) == NULL);
 }
 
 int main(int argc, char **argv) {
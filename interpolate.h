@@ -3,7 +3,21 @@
 
 #include "polynomial.h"
 #include "matrices.h"
+#include <stddef.h>
+
+// counters for the cache of interpolation operators
+typedef struct interpolation_cache_stats {
+	unsigned long hits, misses, evictions;
+	size_t bytes;	// memory held by cached operators
+	int entries;
+} interpolation_cache_stats;
+
+polynomial *interpolate_nodes(vector, vector, int);
 
 polynomial *interpolate(vector, int);
 
+interpolation_cache_stats get_interpolation_cache_stats();
+
+void set_interpolation_cache_limit(size_t);
+
 #endif
@@ -0,0 +1,377 @@
+// lll.c
+// reduces lattice bases with the algorithm of lenstra, lenstra and lovász
+
+#include "lll.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+// basis entries must stay below this, so that they are exact in a matrix_entry
+#define LLL_EXACT_BOUND 0x1p110Q
+// size reductions by more than this are followed by recomputing the gram-schmidt coefficients
+#define LLL_LARGE_REDUCTION 0x1p30Q
+// the floating point reduction gives up after this many iterations per basis vector
+#define LLL_ITERATIONS_PER_VECTOR 100000
+
+static void swap_rows(matrix basis, int i, int j) {
+	for (int l=0; l<basis.n; l++) {
+		matrix_entry temp = basis.entries[i][l];
+		basis.entries[i][l] = basis.entries[j][l];
+		basis.entries[j][l] = temp;
+	}
+}
+
+static matrix_entry dot(vector a, vector b, int n) {
+	matrix_entry result = 0;
+	for (int i=0; i<n; i++) {
+		result += a[i] * b[i];
+	}
+	return result;
+}
+
+// rounds to the nearest integer, without needing quadmath
+static matrix_entry round_entry(matrix_entry x) {
+	if ((x >= 0x1p112Q) || (x <= -0x1p112Q))
+		return x;	// already an integer
+	__int128 result = (__int128) x;
+	matrix_entry remainder = x - (matrix_entry) result;
+	if (remainder > 0.5Q)
+		result++;
+	else if (remainder < -0.5Q)
+		result--;
+	return (matrix_entry) result;
+}
+
+/* ---------- Floating Point Reduction ---------- */
+
+// computes b*_i = b_i - sum_j mu_(i,j) b*_j, with mu_(i,j) = <b_i, b*_j> / ||b*_j||^2, and ||b*_i||^2
+static void gram_schmidt_row(matrix basis, matrix orthogonal, matrix mu, vector norms, int i) {
+	for (int l=0; l<basis.n; l++) {
+		orthogonal.entries[i][l] = basis.entries[i][l];
+	}
+	for (int j=0; j<i; j++) {
+		mu.entries[i][j] = dot(orthogonal.entries[i], orthogonal.entries[j], basis.n) / norms[j];
+		for (int l=0; l<basis.n; l++) {
+			orthogonal.entries[i][l] -= mu.entries[i][j] * orthogonal.entries[j][l];
+		}
+	}
+	norms[i] = dot(orthogonal.entries[i], orthogonal.entries[i], basis.n);
+}
+
+// the basis is kept exact, while the gram-schmidt vectors and coefficients are approximated in matrix_entry
+// the orthogonal vectors are stored explicitly rather than derived from inner products of the basis,
+// since for bases with large entries the latter loses all precision to cancellation
+// returns 0 if the basis grew too large to be exact, the vectors seem dependent, or the iteration limit was hit
+static int floating_lll(matrix basis) {
+	int n = basis.m, dim = basis.n;
+	matrix *mu = alloc_matrix(n, n);
+	matrix *orthogonal = alloc_matrix(n, dim);	// the gram-schmidt vectors b*_i
+	vector norms = (vector) malloc(sizeof(matrix_entry) * n);	// ||b*_i||^2
+	matrix_entry delta = (matrix_entry) LLL_DELTA_NUM / LLL_DELTA_DEN;
+	int success = 1, k = 1, k_max = 0;
+	long iterations = 0;
+	gram_schmidt_row(basis, *orthogonal, *mu, norms, 0);
+	success = (norms[0] > 0);
+	while ((k < n) && success) {
+		success = (++iterations < (long) LLL_ITERATIONS_PER_VECTOR * n);
+		if (k > k_max) {
+			k_max = k;
+			gram_schmidt_row(basis, *orthogonal, *mu, norms, k);
+			success = success && (norms[k] > 0);
+		}
+		// size reduce b_k against b_(k-1), ..., b_0
+		// after a large reduction the updated mu_(k,j) have lost precision, so they are recomputed and the reduction repeated
+		int large_reduction = 1;
+		while (large_reduction && success) {
+			large_reduction = 0;
+			for (int j=k-1; (j>=0) && success; j--) {
+				matrix_entry q = round_entry(mu->entries[k][j]);
+				if (q == 0)
+					continue;
+				large_reduction |= (q > LLL_LARGE_REDUCTION) || (q < -LLL_LARGE_REDUCTION);
+				for (int l=0; l<dim; l++) {
+					basis.entries[k][l] -= q * basis.entries[j][l];
+					success = success && (basis.entries[k][l] < LLL_EXACT_BOUND) && (basis.entries[k][l] > -LLL_EXACT_BOUND);
+				}
+				for (int i=0; i<j; i++) {
+					mu->entries[k][i] -= q * mu->entries[j][i];
+				}
+				mu->entries[k][j] -= q;
+			}
+			for (int j=0; (j<k) && large_reduction; j++) {
+				mu->entries[k][j] = dot(basis.entries[k], orthogonal->entries[j], dim) / norms[j];
+			}
+			success = success && (++iterations < (long) LLL_ITERATIONS_PER_VECTOR * n);
+		}
+		if (!success)
+			break;
+		matrix_entry m = mu->entries[k][k - 1];
+		if (norms[k] < (delta - m * m) * norms[k - 1]) {
+			// swap b_k and b_(k-1), and recompute the gram-schmidt data of the rows from k-1 on
+			// the usual in-place update of that data loses too much precision for bases with large entries
+			swap_rows(basis, k, k - 1);
+			for (int i=k-1; i<=k_max; i++) {
+				gram_schmidt_row(basis, *orthogonal, *mu, norms, i);
+			}
+			success = (norms[k - 1] > 0) && (norms[k] > 0);
+			if (k > 1)
+				k--;
+		} else {
+			k++;
+		}
+	}
+	free_matrix(mu);
+	free_matrix(orthogonal);
+	free(norms);
+
+	return success;
+}
+
+/* ---------- Integral Reduction ---------- */
+
+// arithmetic on __int128 which records overflow instead of wrapping
+
+static __int128 mul_checked(__int128 a, __int128 b, int *overflow) {
+	__int128 result;
+	*overflow |= __builtin_mul_overflow(a, b, &result);
+	return result;
+}
+
+static __int128 add_checked(__int128 a, __int128 b, int *overflow) {
+	__int128 result;
+	*overflow |= __builtin_add_overflow(a, b, &result);
+	return result;
+}
+
+static __int128 sub_checked(__int128 a, __int128 b, int *overflow) {
+	__int128 result;
+	*overflow |= __builtin_sub_overflow(a, b, &result);
+	return result;
+}
+
+// returns the nearest integer to a / b, for b > 0
+static __int128 round_quotient(__int128 a, __int128 b) {
+	__int128 q = a / b, r = a % b;
+	if (2 * r > b)
+		q++;
+	else if (2 * r < -b)
+		q--;
+	return q;
+}
+
+// size reduces b_k against b_l, following cohen's notation with vectors indexed from 1
+static void reduce_integral(__int128 **b, int dim, __int128 **lambda, __int128 *d, int k, int l, int *overflow) {
+	__int128 twice = mul_checked(2, lambda[k][l], overflow);
+	if ((twice <= d[l]) && (-twice <= d[l]))
+		return;
+	__int128 q = round_quotient(lambda[k][l], d[l]);
+	for (int i=0; i<dim; i++) {
+		b[k][i] = sub_checked(b[k][i], mul_checked(q, b[l][i], overflow), overflow);
+	}
+	lambda[k][l] = sub_checked(lambda[k][l], mul_checked(q, d[l], overflow), overflow);
+	for (int i=1; i<l; i++) {
+		lambda[k][i] = sub_checked(lambda[k][i], mul_checked(q, lambda[l][i], overflow), overflow);
+	}
+}
+
+// exact lll, keeping the gram-schmidt data as integers as in algorithm 2.6.7 of cohen
+// d[i] is the gram determinant of b_1, ..., b_i, and lambda[k][j] = d[j] * mu_(k,j)
+// returns 0 if an intermediate value overflows or the vectors are dependent
+static int integral_lll(matrix basis) {
+	int n = basis.m, dim = basis.n, overflow = 0;
+	__int128 **b = (__int128**) malloc(sizeof(__int128*) * (n + 1));
+	__int128 **lambda = (__int128**) malloc(sizeof(__int128*) * (n + 1));
+	__int128 *d = (__int128*) calloc(n + 1, sizeof(__int128));
+	for (int i=1; i<=n; i++) {
+		b[i] = (__int128*) malloc(sizeof(__int128) * dim);
+		lambda[i] = (__int128*) calloc(n + 1, sizeof(__int128));
+		for (int j=0; j<dim; j++) {
+			b[i][j] = (__int128) basis.entries[i - 1][j];
+		}
+	}
+	d[0] = 1;
+	for (int i=0; i<dim; i++) {
+		d[1] = add_checked(d[1], mul_checked(b[1][i], b[1][i], &overflow), &overflow);
+	}
+	int k = 2, k_max = 1, dependent = (d[1] == 0);
+	while ((k <= n) && !overflow && !dependent) {
+		if (k > k_max) {
+			k_max = k;
+			for (int j=1; j<=k; j++) {
+				__int128 u = 0;
+				for (int i=0; i<dim; i++) {
+					u = add_checked(u, mul_checked(b[k][i], b[j][i], &overflow), &overflow);
+				}
+				for (int i=1; i<j; i++) {
+					u = sub_checked(mul_checked(d[i], u, &overflow), mul_checked(lambda[k][i], lambda[j][i], &overflow), &overflow) / d[i - 1];
+				}
+				if (j < k)
+					lambda[k][j] = u;
+				else
+					d[k] = u;
+			}
+			dependent = (d[k] == 0);
+		}
+		reduce_integral(b, dim, lambda, d, k, k - 1, &overflow);
+		// lovász condition: d_k d_(k-2) >= delta d_(k-1)^2 - lambda_(k,k-1)^2
+		__int128 left = mul_checked(LLL_DELTA_DEN, mul_checked(d[k], d[k - 2], &overflow), &overflow);
+		__int128 right = sub_checked(mul_checked(LLL_DELTA_NUM, mul_checked(d[k - 1], d[k - 1], &overflow), &overflow),
+				mul_checked(LLL_DELTA_DEN, mul_checked(lambda[k][k - 1], lambda[k][k - 1], &overflow), &overflow), &overflow);
+		if (overflow || dependent)
+			break;
+		if (left < right) {
+			__int128 *temp = b[k];
+			b[k] = b[k - 1];
+			b[k - 1] = temp;
+			for (int j=1; j<k-1; j++) {
+				__int128 swap = lambda[k][j];
+				lambda[k][j] = lambda[k - 1][j];
+				lambda[k - 1][j] = swap;
+			}
+			__int128 l = lambda[k][k - 1];
+			__int128 new_d = add_checked(mul_checked(d[k - 2], d[k], &overflow), mul_checked(l, l, &overflow), &overflow) / d[k - 1];
+			for (int i=k+1; i<=k_max; i++) {
+				__int128 t = lambda[i][k];
+				lambda[i][k] = sub_checked(mul_checked(d[k], lambda[i][k - 1], &overflow), mul_checked(l, t, &overflow), &overflow) / d[k - 1];
+				lambda[i][k - 1] = add_checked(mul_checked(new_d, t, &overflow), mul_checked(l, lambda[i][k], &overflow), &overflow) / d[k];
+			}
+			d[k - 1] = new_d;
+			if (k > 2)
+				k--;
+		} else {
+			for (int l=k-2; l>=1; l--) {
+				reduce_integral(b, dim, lambda, d, k, l, &overflow);
+			}
+			k++;
+		}
+	}
+	int success = !overflow && !dependent;
+	for (int i=1; i<=n; i++) {
+		if (success) {
+			for (int j=0; j<dim; j++) {
+				basis.entries[i - 1][j] = (matrix_entry) b[i][j];
+			}
+		}
+		free(b[i]);
+		free(lambda[i]);
+	}
+	free(b);
+	free(lambda);
+	free(d);
+
+	return success;
+}
+
+/* ---------- Reduction ---------- */
+
+// replaces the rows of basis, which must be linearly independent with integer entries, by an lll-reduced basis of their lattice
+// uses floating point gram-schmidt coefficients, and falls back to exact integer arithmetic if that fails
+// returns 0 if both fail, in which case the basis is left unchanged
+int lll_reduce(matrix basis) {
+	if (basis.m == 0)
+		return 1;
+	matrix *original = copy_matrix(basis);
+	int success = floating_lll(basis);
+	if (!success) {
+		// start over from the original basis
+		for (int i=0; i<basis.m; i++) {
+			for (int j=0; j<basis.n; j++) {
+				basis.entries[i][j] = original->entries[i][j];
+			}
+		}
+		success = integral_lll(basis);
+	}
+	free_matrix(original);
+
+	return success;
+}
+
+/* ---------- Integer Relations ---------- */
+
+// finds a short integer vector r with r_0*values[0] + ... + r_(n-1)*values[n-1] near 0, and stores it in relation
+// reduces the lattice spanned by the rows (e_i, round(scale*values[i])), so the combination found is about 1/scale
+// times the length of r; scale*|values[i]| should stay below LLL_EXACT_BOUND
+// returns 0 if lattice reduction fails
+int find_integer_relation(vector values, int n, matrix_entry scale, vector relation) {
+	matrix *basis = alloc_matrix(n, n + 1);
+	for (int i=0; i<n; i++) {
+		for (int j=0; j<n; j++) {
+			basis->entries[i][j] = (i == j);
+		}
+		basis->entries[i][n] = round_entry(scale * values[i]);
+	}
+	int success = lll_reduce(*basis);
+	for (int j=0; (j<n) && success; j++) {
+		relation[j] = basis->entries[0][j];
+	}
+	free_matrix(basis);
+
+	return success;
+}
+
+/* ---------- Testing ---------- */
+// to test, run "make test lll"
+
+#ifdef TEST_LLL
+
+static void print_integer_rows(matrix a) {
+	for (int i=0; i<a.m; i++) {
+		for (int j=0; j<a.n; j++) {
+			printf("%lld%s", (long long) a.entries[i][j], (j + 1 < a.n) ? " " : "\n");
+		}
+	}
+}
+
+/* should output:
+ * lll_reduce: 1
+ * 0 1 0
+ * 1 0 1
+ * -1 0 2
+ * integral: 1
+ * 0 1 0
+ * 1 0 1
+ * -1 0 2
+ * knapsack: 1
+ * find_integer_relation: 1, -1 -1 1 */
+void test_lll() {
+	int rows[3][3] = {{1, 1, 1}, {-1, 0, 2}, {3, 5, 6}};
+	matrix *basis = alloc_matrix(3, 3);
+	for (int i=0; i<3; i++) {
+		for (int j=0; j<3; j++) {
+			basis->entries[i][j] = rows[i][j];
+		}
+	}
+	matrix *integral = copy_matrix(*basis);
+	printf("lll_reduce: %d\n", lll_reduce(*basis));
+	print_integer_rows(*basis);
+	printf("integral: %d\n", integral_lll(*integral));
+	print_integer_rows(*integral);
+	// the knapsack 3*a + 5*b + 7*c = 0 with a large multiplier; the first reduced vector should be a short solution
+	matrix *knapsack = alloc_matrix(3, 4);
+	int weights[3] = {3, 5, 7};
+	for (int i=0; i<3; i++) {
+		for (int j=0; j<3; j++) {
+			knapsack->entries[i][j] = (i == j);
+		}
+		knapsack->entries[i][3] = 1000000 * weights[i];
+	}
+	lll_reduce(*knapsack);
+	matrix_entry sum = 0;
+	for (int i=0; i<3; i++) {
+		sum += weights[i] * knapsack->entries[0][i];
+	}
+	printf("knapsack: %d\n", (sum == 0) && (knapsack->entries[0][3] == 0));
+	// 1, phi and phi^2 satisfy phi^2 = phi + 1, up to sign
+	matrix_entry phi = (1 + 2.2360679774997896964091736687312762Q) / 2;
+	matrix_entry values[3] = {1, phi, phi * phi}, relation[3];
+	int found = find_integer_relation(values, 3, 0x1p60Q, relation);
+	int sign = (relation[2] < 0) ? -1 : 1;
+	printf("find_integer_relation: %d, %lld %lld %lld\n", found, (long long) (sign * relation[0]), (long long) (sign * relation[1]), (long long) (sign * relation[2]));
+}
+
+int main(int argc, char **argv) {
+	test_lll();
+	exit(0);
+}
+
+#endif
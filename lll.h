@@ -0,0 +1,16 @@
+// lll.h
+
+#ifndef LLL_H
+#define LLL_H
+
+#include "matrices.h"
+
+// the lovász condition ||b*_k||^2 >= (delta - mu_(k,k-1)^2) ||b*_(k-1)||^2, with delta = LLL_DELTA_NUM / LLL_DELTA_DEN
+#define LLL_DELTA_NUM 99
+#define LLL_DELTA_DEN 100
+
+int lll_reduce(matrix);
+
+int find_integer_relation(vector, int, matrix_entry, vector);
+
+#endif
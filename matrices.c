@@ -2,13 +2,21 @@
 // used for calculating determinants and inverses
 
 #include "matrices.h"
+#include "modular.h"
+#include "threads.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
 #include <math.h>
 #include <float.h>
+#include <string.h>
 #define alt(i) ((i % 2 == 0) ? 1 : -1)
+#define min(a, b) ((a < b) ? a : b)
 #define EFF_DET_CUTOFF 5
+#define MATRIX_ALIGN 64	// alignment in bytes of the start of each row
+#define MATRIX_BLOCK 32	// side length of the tiles used by the blocked algorithms
+#define PARALLEL_CUTOFF 1000000	// minimum number of multiply-adds worth dividing between threads
+#define MAX_REFINE_ITER 30	// maximum number of steps of iterative refinement
 
 /* ---------- Constructors ---------- */
 
@@ -30,36 +38,38 @@ matrix *identity_matrix(int n) {
 
 /* ---------- Memory Functions ---------- */
 
+// allocates an m-by-n matrix as a single aligned buffer
+// rows are padded to a multiple of MATRIX_ALIGN bytes, and entries[i] points to the start of the ith row
 matrix *alloc_matrix(int m, int n) {
 	matrix *result = (matrix*) malloc(sizeof(matrix));
 	result->m = m;
 	result->n = n;
+	int entries_per_align = MATRIX_ALIGN / sizeof(matrix_entry);
+	if (entries_per_align == 0)
+		entries_per_align = 1;
+	result->stride = ((n + entries_per_align - 1) / entries_per_align) * entries_per_align;
+	void *data = NULL;
+	int alloc_failed = posix_memalign(&data, MATRIX_ALIGN, sizeof(matrix_entry) * result->stride * (m > 0 ? m : 1));
+	assert(!alloc_failed);
+	result->data = (matrix_entry*) data;
 	result->entries = (vector*) malloc(sizeof(vector) * m);
 	for (int i=0; i<m; i++) {
-		result->entries[i] = (vector) malloc(sizeof(matrix_entry) * n);
+		result->entries[i] = result->data + i * result->stride;
 	}
 	
 	return result;
 }
 
 void free_matrix(matrix *a) {
-	for (int i=0; i<a->m; i++) {
-		free(a->entries[i]);
-	}
+	free(a->data);
 	free(a->entries);
 	free(a);
 }
 
 matrix *copy_matrix(matrix a) {
-	matrix *cpy = (matrix*) malloc(sizeof(matrix));
-	cpy->m = a.m;
-	cpy->n = a.n;
-	cpy->entries = (vector*) malloc(sizeof(vector) * cpy->m);
+	matrix *cpy = alloc_matrix(a.m, a.n);
 	for (int i=0; i<cpy->m; i++) {
-		cpy->entries[i] = (vector) malloc(sizeof(matrix_entry) * cpy->n);
-		for (int j=0; j<cpy->n; j++) {
-			cpy->entries[i][j] = a.entries[i][j];
-		}
+		memcpy(cpy->entries[i], a.entries[i], sizeof(matrix_entry) * a.n);
 	}
 	
 	return cpy;
@@ -78,17 +88,64 @@ vector matrix_eval(matrix a, vector v) {
 	return result;
 }
 
+// computes c += a*b, or c -= a*b if subtract is nonzero, where a is rows-by-inner and b is inner-by-cols
+// the matrices are given by row pointers which may be offset to start at any column
+// the loops are tiled so that each block of b is reused from cache, and the innermost loop
+// runs over contiguous entries so that it vectorizes when matrix_entry is a hardware type
+// runtime: O(rows*inner*cols)
+static void mult_add_kernel(vector *c, vector *a, vector *b, int rows, int inner, int cols, int subtract) {
+	for (int jj=0; jj<cols; jj+=MATRIX_BLOCK) {
+		int j_end = min(jj + MATRIX_BLOCK, cols);
+		for (int kk=0; kk<inner; kk+=MATRIX_BLOCK) {
+			int k_end = min(kk + MATRIX_BLOCK, inner);
+			for (int i=0; i<rows; i++) {
+				matrix_entry *restrict c_row = c[i];
+				for (int k=kk; k<k_end; k++) {
+					matrix_entry a_entry = subtract ? -a[i][k] : a[i][k];
+					if (a_entry == 0)
+						continue;
+					const matrix_entry *restrict b_row = b[k];
+					for (int j=jj; j<j_end; j++)
+						c_row[j] += a_entry * b_row[j];
+				}
+			}
+		}
+	}
+}
+
+// the arguments of mult_add_kernel, shared by the tasks of parallel_mult_add
+typedef struct mult_add_job {
+	vector *c, *a, *b;
+	int rows, inner, cols, subtract;
+} mult_add_job;
+
+// runs mult_add_kernel on the taskth tile of rows
+static void mult_add_task(int task, int worker, void *arg) {
+	mult_add_job *job = (mult_add_job*) arg;
+	int row_start = task * MATRIX_BLOCK;
+	int rows = min(MATRIX_BLOCK, job->rows - row_start);
+	mult_add_kernel(job->c + row_start, job->a + row_start, job->b, rows, job->inner, job->cols, job->subtract);
+}
+
+// same as mult_add_kernel, but large products are divided between threads by tiles of rows
+static void parallel_mult_add(vector *c, vector *a, vector *b, int rows, int inner, int cols, int subtract) {
+	if ((double) rows * inner * cols < PARALLEL_CUTOFF) {
+		mult_add_kernel(c, a, b, rows, inner, cols, subtract);
+		return;
+	}
+	mult_add_job job = {c, a, b, rows, inner, cols, subtract};
+	parallel_for((rows + MATRIX_BLOCK - 1) / MATRIX_BLOCK, mult_add_task, &job);
+}
+
 // runtime: O(a.m*a.n*b.n)
 matrix *matrix_mult(matrix a, matrix b) {
 	assert(a.n == b.m);	// otherwise product is not defined
 	matrix *result = alloc_matrix(a.m, b.n);
 	for (int i=0; i<result->m; i++) {
-		for (int j=0; j<result->n; j++) {
-			result->entries[i][j] = 0;
-			for (int k=0; k<a.n; k++)
-				result->entries[i][j] += a.entries[i][k] * b.entries[k][j];
-		}
+		memset(result->entries[i], 0, sizeof(matrix_entry) * result->n);
 	}
+	parallel_mult_add(result->entries, a.entries, b.entries, a.m, a.n, b.n, 0);
+	
 	return result;
 }
 
@@ -123,7 +180,6 @@ static matrix_entry ineff_det(matrix a) {
 
 // exchanges row1 and row2 in a
 static void exchange_rows(matrix a, int row1, int row2) {
-	printf("exchange\n");
 	assert((a.m > row1) && (a.m > row2));
 	for (int i=0; i<a.n; i++) {
 		matrix_entry temp_entry = a.entries[row1][i];
@@ -132,60 +188,139 @@ static void exchange_rows(matrix a, int row1, int row2) {
 	}
 }
 
+// the panel of a being factored by lu_factor
+typedef struct panel_job {
+	matrix a;
+	int kb, k_end;	// the panel consists of columns kb,...,k_end-1
+} panel_job;
+
+// applies the forward substitution by the panel's block of l to the taskth tile of columns right of the panel
+static void panel_solve_task(int task, int worker, void *arg) {
+	panel_job *job = (panel_job*) arg;
+	int col_start = job->k_end + task * MATRIX_BLOCK;
+	int col_end = min(col_start + MATRIX_BLOCK, job->a.n);
+	for (int k=job->kb; k<job->k_end; k++) {
+		const matrix_entry *restrict k_row = job->a.entries[k];
+		for (int i=k+1; i<job->k_end; i++) {
+			matrix_entry *restrict i_row = job->a.entries[i];
+			matrix_entry l_entry = i_row[k];
+			for (int j=col_start; j<col_end; j++)
+				i_row[j] -= l_entry * k_row[j];
+		}
+	}
+}
+
+// factors a in place as pa = lu with partial pivoting
+// l is unit lower triangular and is stored below the diagonal of a, u is stored on and above it
+// perm[i] is set to the row of the original matrix which ends up in row i
+// returns the number of rows exchanged
+// uses a right-looking blocked algorithm, so that most of the work is done by mult_add_kernel
+// runtime: O(n^3)
+static int lu_factor(matrix a, int *perm) {
+	assert(a.n == a.m);	// only defined for square matrices
+	int n = a.m, row_exchanges = 0;
+	for (int i=0; i<n; i++)
+		perm[i] = i;
+	vector *l_rows = (vector*) malloc(sizeof(vector) * n);
+	vector *u_rows = (vector*) malloc(sizeof(vector) * n);
+	for (int kb=0; kb<n; kb+=MATRIX_BLOCK) {
+		int k_end = min(kb + MATRIX_BLOCK, n);
+		// factor the panel of columns kb,...,k_end-1
+		for (int k=kb; k<k_end; k++) {
+			// choose the entry of largest absolute value in column k as the pivot
+			int pivot_row = k;
+			for (int i=k+1; i<n; i++) {
+				if (fabs(a.entries[i][k]) > fabs(a.entries[pivot_row][k]))
+					pivot_row = i;
+			}
+			if (pivot_row != k) {
+				exchange_rows(a, k, pivot_row);
+				int temp_ind = perm[k];
+				perm[k] = perm[pivot_row];
+				perm[pivot_row] = temp_ind;
+				row_exchanges++;
+			}
+			// a zero pivot means a is singular; the column is already eliminated
+			if (a.entries[k][k] == 0)
+				continue;
+			for (int i=k+1; i<n; i++) {
+				matrix_entry l_entry = a.entries[i][k] / a.entries[k][k];
+				a.entries[i][k] = l_entry;	// store l
+				for (int j=k+1; j<k_end; j++)
+					a.entries[i][j] -= l_entry * a.entries[k][j];
+			}
+		}
+		if (k_end == n)
+			break;
+		// compute the block row of u to the right of the panel by forward substitution
+		// the tiles of columns are independent, so large matrices divide them between threads
+		panel_job job = {a, kb, k_end};
+		int num_col_tiles = (n - k_end + MATRIX_BLOCK - 1) / MATRIX_BLOCK;
+		if ((double) MATRIX_BLOCK * MATRIX_BLOCK * (n - k_end) < PARALLEL_CUTOFF) {
+			for (int tile=0; tile<num_col_tiles; tile++)
+				panel_solve_task(tile, 0, &job);
+		} else {
+			parallel_for(num_col_tiles, panel_solve_task, &job);
+		}
+		// update the trailing submatrix
+		for (int i=k_end; i<n; i++) {
+			l_rows[i - k_end] = a.entries[i] + kb;
+			u_rows[i - k_end] = a.entries[i] + k_end;
+		}
+		vector *panel_rows = a.entries + kb;
+		vector *block_u_rows = (vector*) malloc(sizeof(vector) * (k_end - kb));
+		for (int k=kb; k<k_end; k++)
+			block_u_rows[k - kb] = panel_rows[k - kb] + k_end;
+		parallel_mult_add(u_rows, l_rows, block_u_rows, n - k_end, k_end - kb, n - k_end, 1);
+		free(block_u_rows);
+	}
+	free(l_rows);
+	free(u_rows);
+	
+	return row_exchanges;
+}
+
 // given a matrix a, converts it to a matrix u and returns p and l where pa = lu
 // adds number of rows exchanged to row_exchanges (if unneeded just use NULL)
-// uses the doolittle algorithm
 // runtime: O(n^3)
 static matrix **lu_decomp(matrix *a, int *row_exchanges) {
 	assert(a->n == a->m);	// only defined for square matrices
+	int *perm = (int*) malloc(sizeof(int) * a->m);
+	int exchanges = lu_factor(*a, perm);
+	if (row_exchanges != NULL)
+		*row_exchanges += exchanges;
 	matrix **pl = (matrix**) malloc(sizeof(matrix*) * 2);
-	pl[0] = identity_matrix(a->m);	// the matrix p
+	pl[0] = alloc_matrix(a->m, a->m);	// the matrix p
 	pl[1] = identity_matrix(a->m);	// the matrix l
-
-	for (int n=0; n<a->m-1; n++) {
-		// permute a so that a->entries[n][n] is invertible
-		if (fabs(a->entries[n][n]) < DBL_MIN) {
-			// find a row below n with nonzero nth entry
-			int new_row = n;
-			while (fabs(a->entries[++new_row][n]) < DBL_MIN) {
-				// assert that we are not at the last row
-				assert(new_row < a->m);
-			}
-			// exchange appropriate rows of a and p
-			exchange_rows(*a, n, new_row);
-			exchange_rows(*pl[0], n, new_row);
-			if (row_exchanges != NULL)
-				*row_exchanges++;
-		}
-		// perform elimination
-		for (int i=n+1; i<a->m; i++) {
-			matrix_entry l_entry = a->entries[i][n] / a->entries[n][n];
-			pl[1]->entries[i][n] = l_entry; // update l
-			// subtract l_entry * the nth row of a from the ith row
-			for (int j=0; j<a->n; j++) {
-				a->entries[i][j] -= l_entry * a->entries[n][j];
-			}
+	// split the compact factorization into l and u, and expand perm into p
+	for (int i=0; i<a->m; i++) {
+		memset(pl[0]->entries[i], 0, sizeof(matrix_entry) * a->m);
+		pl[0]->entries[i][perm[i]] = 1.0;
+		for (int j=0; j<i; j++) {
+			pl[1]->entries[i][j] = a->entries[i][j];
+			a->entries[i][j] = 0;
 		}
 	}
+	free(perm);
 	
-//	pl[0] = transpose(pl[0]); // inverts p, giving a = plu
 	return pl;
 }
 
 // determinant computed using LU-decomposition
 // runtime: O(n^3)
 static matrix_entry eff_det(matrix a) {
-	// make a copy of a so that the entries are not affected by lu_decomp
+	// make a copy of a so that the entries are not affected by lu_factor
 	matrix *a_cpy = copy_matrix(a);
+	int *perm = (int*) malloc(sizeof(int) * a.m);
 	
-	int row_exchanges = 0;
-	lu_decomp(a_cpy, &row_exchanges);
-	// a is now upper triangular with same determinant up to sign
+	int row_exchanges = lu_factor(*a_cpy, perm);
+	// the diagonal of a_cpy is now that of u, which has the same determinant as a up to sign
 	matrix_entry result = alt(row_exchanges);	// takes care of sign
 	for (int i=0; i<a_cpy->m; i++) {
 		result *= a_cpy->entries[i][i];
 	}
 	free_matrix(a_cpy);
+	free(perm);
 	 
 	return result;
 }
@@ -198,57 +333,183 @@ matrix_entry det(matrix a) {
 	return eff_det(a);
 }
 
-static matrix *transpose(matrix a) {
-	matrix *result = alloc_matrix(a.n, a.m);
-	for (int i=0; i<result->m; i++) {
-		for (int j=0; j<result->n; j++)
-			result->entries[i][j] = a.entries[j][i];
+// computes the determinant of an n-by-n matrix modulo m by gaussian elimination
+// rows holds the matrix in montgomery form and is overwritten
+// runtime: O(n^3)
+static uint64_t det_mod_prime(uint64_t **rows, int n, modulus m) {
+	uint64_t result = to_mod(1, m);
+	for (int k=0; k<n; k++) {
+		// find a row at or below k with nonzero kth entry
+		int pivot_row = k;
+		while ((pivot_row < n) && (rows[pivot_row][k] == 0))
+			pivot_row++;
+		if (pivot_row == n)
+			return 0;	// the matrix is singular mod p
+		if (pivot_row != k) {
+			uint64_t *temp_row = rows[k];
+			rows[k] = rows[pivot_row];
+			rows[pivot_row] = temp_row;
+			result = mod_neg(result, m);
+		}
+		result = mod_mult(result, rows[k][k], m);
+		uint64_t pivot_inv = mod_inverse(rows[k][k], m);
+		// perform elimination
+		for (int i=k+1; i<n; i++) {
+			if (rows[i][k] == 0)
+				continue;
+			uint64_t l_entry = mod_mult(rows[i][k], pivot_inv, m);
+			for (int j=k+1; j<n; j++)
+				rows[i][j] = mod_sub(rows[i][j], mod_mult(l_entry, rows[k][j], m), m);
+		}
 	}
+
 	return result;
 }
 
-// inverts a lower-triangular matrix by forward substitution
-// runtime: O(n^3)
-static matrix *invert_lower_tri_matrix(matrix a) {
-	matrix *identity = identity_matrix(a.m);
-	// first we calculate the transpose of the result, as this is easier
-	matrix *result_transposed = alloc_matrix(a.m, a.n);
-	for (int i=0; i<a.m; i++) {
-		for (int j=0; j<a.n; j++) {
-			matrix_entry sum_previous_entries = 0;
-			for (int k=0; k<j; k++) {
-				sum_previous_entries += a.entries[j][k] * result_transposed->entries[i][k];
-			}
-			result_transposed->entries[i][j] = (identity->entries[i][j] - sum_previous_entries) / a.entries[j][j];
+// the primes integer_det works modulo, shared by the tasks computing the determinant modulo each
+typedef struct det_job {
+	matrix a;
+	uint64_t *residues;		// by prime
+	uint64_t **entries;		// by worker, allocated by the first task the worker runs
+	uint64_t ***rows;		// by worker, pointers into entries
+} det_job;
+
+// computes the determinant modulo the taskth prime, in the buffers of the worker running it
+static void det_task(int task, int worker, void *arg) {
+	det_job *job = (det_job*) arg;
+	int n = job->a.n;
+	if (job->entries[worker] == NULL) {
+		job->entries[worker] = (uint64_t*) malloc(sizeof(uint64_t) * n * n);
+		job->rows[worker] = (uint64_t**) malloc(sizeof(uint64_t*) * n);
+	}
+	uint64_t **rows = job->rows[worker];
+	modulus m = modular_prime(task);
+	for (int i=0; i<n; i++) {
+		rows[i] = job->entries[worker] + i * n;
+		for (int j=0; j<n; j++)
+			rows[i][j] = to_mod((long long) job->a.entries[i][j], m);
+	}
+	job->residues[task] = from_mod(det_mod_prime(rows, n, m), m);
+}
+
+// determinant of a matrix with integer entries, computed exactly modulo several primes
+// the number of primes is chosen from the hadamard bound, the primes are divided between the worker threads,
+// and the result is recovered by chinese remaindering
+// runtime: O(n^3 * log(hadamard bound))
+matrix_entry integer_det(matrix a) {
+	assert(a.m == a.n);	// only defined for square matrices
+	int n = a.n;
+	// hadamard's inequality bounds the determinant by the product of the row norms
+	double bound_bits = 0;
+	for (int i=0; i<n; i++) {
+		double row_norm_sq = 0;
+		for (int j=0; j<n; j++) {
+			assert(fabs((double) a.entries[i][j]) < 9e18);	// entries must fit in a long long
+			row_norm_sq += (double) a.entries[i][j] * (double) a.entries[i][j];
 		}
+		if (row_norm_sq == 0)
+			return 0;
+		bound_bits += log2(row_norm_sq) / 2.0;
 	}
-	free_matrix(identity);
-	matrix *result = transpose(*result_transposed);
-	free_matrix(result_transposed);
+	// if the table does not have enough primes, fall back to floating point
+	if (bound_bits + 2.0 > NUM_MODULAR_PRIMES * MODULAR_PRIME_BITS)
+		return det(a);
+	int num_primes = primes_for_bits(bound_bits);
 	
+	det_job job;
+	job.a = a;
+	job.residues = (uint64_t*) malloc(sizeof(uint64_t) * num_primes);
+	int num_scratch = num_workers();
+	job.entries = (uint64_t**) calloc(num_scratch, sizeof(uint64_t*));
+	job.rows = (uint64_t***) calloc(num_scratch, sizeof(uint64_t**));
+	parallel_for(num_primes, det_task, &job);
+	matrix_entry result = crt_reconstruct(job.residues, num_primes, NULL);
+	for (int i=0; i<num_scratch; i++) {
+		free(job.entries[i]);
+		free(job.rows[i]);
+	}
+	free(job.residues);
+	free(job.entries);
+	free(job.rows);
+
 	return result;
 }
 
-// inverts an upper-triangular matrix by converting to a lower-triangular one and using the above algorithm
-// runtime: O(n^3)
-static matrix *invert_upper_tri_matrix(matrix a) {
-	matrix *identity = identity_matrix(a.m);
-	matrix *lower_tri = transpose(a);
-	// same as before, only we do not transpose the result
-	matrix *result = alloc_matrix(a.m, a.n);
-	for (int i=0; i<a.m; i++) {
-		for (int j=0; j<a.n; j++) {
-			matrix_entry sum_previous_entries = 0;
-			for (int k=0; k<j; k++) {
-				sum_previous_entries += lower_tri->entries[j][k] * result->entries[i][k];
-			}
-			result->entries[i][j] = (identity->entries[i][j] - sum_previous_entries) / lower_tri->entries[j][j];
+// a triangular matrix being inverted, along with the result
+typedef struct tri_inverse_job {
+	matrix a, *result;
+} tri_inverse_job;
+
+// computes the taskth tile of columns of the inverse of a lower-triangular matrix by forward substitution
+// row i of the result only has nonzero entries in columns 0,...,i
+static void lower_tri_inverse_task(int task, int worker, void *arg) {
+	tri_inverse_job *job = (tri_inverse_job*) arg;
+	int n = job->a.m, col_start = task * MATRIX_BLOCK, col_end = min(col_start + MATRIX_BLOCK, n);
+	for (int i=0; i<n; i++) {
+		matrix_entry *restrict result_row = job->result->entries[i];
+		for (int j=col_start; j<col_end; j++)
+			result_row[j] = (i == j) ? 1.0 : 0.0;
+		if (i < col_start)
+			continue;
+		for (int k=col_start; k<i; k++) {
+			matrix_entry l_entry = job->a.entries[i][k];
+			const matrix_entry *restrict prev_row = job->result->entries[k];
+			int k_end = min(k + 1, col_end);
+			for (int j=col_start; j<k_end; j++)
+				result_row[j] -= l_entry * prev_row[j];
 		}
+		int i_end = min(i + 1, col_end);
+		for (int j=col_start; j<i_end; j++)
+			result_row[j] /= job->a.entries[i][i];
+	}
+}
+
+// computes the taskth tile of columns of the inverse of an upper-triangular matrix by back substitution
+// row i of the result only has nonzero entries in columns i,...,n-1
+static void upper_tri_inverse_task(int task, int worker, void *arg) {
+	tri_inverse_job *job = (tri_inverse_job*) arg;
+	int n = job->a.m, col_start = task * MATRIX_BLOCK, col_end = min(col_start + MATRIX_BLOCK, n);
+	for (int i=n-1; i>=0; i--) {
+		matrix_entry *restrict result_row = job->result->entries[i];
+		for (int j=col_start; j<col_end; j++)
+			result_row[j] = (i == j) ? 1.0 : 0.0;
+		if (i >= col_end)
+			continue;
+		for (int k=i+1; k<col_end; k++) {
+			matrix_entry u_entry = job->a.entries[i][k];
+			const matrix_entry *restrict next_row = job->result->entries[k];
+			for (int j=(k > col_start ? k : col_start); j<col_end; j++)
+				result_row[j] -= u_entry * next_row[j];
+		}
+		for (int j=(i > col_start ? i : col_start); j<col_end; j++)
+			result_row[j] /= job->a.entries[i][i];
+	}
+}
+
+// runs a triangular inversion, dividing the tiles of columns between threads for large matrices
+static matrix *tri_inverse(matrix a, task_function tile_task) {
+	int n = a.m, num_tiles = (n + MATRIX_BLOCK - 1) / MATRIX_BLOCK;
+	tri_inverse_job job = {a, alloc_matrix(n, n)};
+	if ((double) n * n * n / 6.0 < PARALLEL_CUTOFF) {
+		for (int tile=0; tile<num_tiles; tile++)
+			tile_task(tile, 0, &job);
+	} else {
+		parallel_for(num_tiles, tile_task, &job);
 	}
-	free_matrix(identity);
-	free_matrix(lower_tri);
 	
-	return result;
+	return job.result;
+}
+
+// inverts a lower-triangular matrix by forward substitution
+// runtime: O(n^3)
+static matrix *invert_lower_tri_matrix(matrix a) {
+	return tri_inverse(a, lower_tri_inverse_task);
+}
+
+// inverts an upper-triangular matrix by back substitution
+// runtime: O(n^3)
+static matrix *invert_upper_tri_matrix(matrix a) {
+	return tri_inverse(a, upper_tri_inverse_task);
 }
 
 // runtime: O(n^3)
@@ -273,6 +534,232 @@ matrix *invert_matrix(matrix a) {
 	return result;
 }
 
+// solves ax = b into x, given the factorization pa = lu computed by lu_factor
+// runtime: O(n^2)
+static void lu_solve(matrix lu, int *perm, vector b, vector x) {
+	int n = lu.m;
+	// solve ly = pb by forward substitution
+	for (int i=0; i<n; i++) {
+		matrix_entry sum = b[perm[i]];
+		for (int j=0; j<i; j++)
+			sum -= lu.entries[i][j] * x[j];
+		x[i] = sum;
+	}
+	// solve ux = y by back substitution
+	for (int i=n-1; i>=0; i--) {
+		matrix_entry sum = x[i];
+		for (int j=i+1; j<n; j++)
+			sum -= lu.entries[i][j] * x[j];
+		assert(lu.entries[i][i] != 0);	// a must be invertible
+		x[i] = sum / lu.entries[i][i];
+	}
+}
+
+// solves ax = b, returning x
+// cheaper and more accurate than computing invert_matrix(a) and applying it to b
+// runtime: O(n^3) for the factorization, then O(n^2)
+vector solve_linear_system(matrix a, vector b) {
+	assert(a.m == a.n);	// only defined for square matrices
+	int n = a.m;
+	matrix *lu = copy_matrix(a);
+	int *perm = (int*) malloc(sizeof(int) * n);
+	lu_factor(*lu, perm);
+	vector result = (vector) malloc(sizeof(matrix_entry) * n);
+	lu_solve(*lu, perm, b, result);
+	free_matrix(lu);
+	free(perm);
+	
+	return result;
+}
+
+// factors the n-by-n row-major array a in place as pa = lu in hardware double precision
+// perm is filled in as in lu_factor
+// returns 0 if a is singular to working precision, 1 otherwise
+// runtime: O(n^3)
+static int double_lu_factor(double *a, int n, int *perm) {
+	for (int i=0; i<n; i++)
+		perm[i] = i;
+	for (int k=0; k<n; k++) {
+		int pivot_row = k;
+		for (int i=k+1; i<n; i++) {
+			if (fabs(a[i * n + k]) > fabs(a[pivot_row * n + k]))
+				pivot_row = i;
+		}
+		if (a[pivot_row * n + k] == 0)
+			return 0;
+		if (pivot_row != k) {
+			for (int j=0; j<n; j++) {
+				double temp_entry = a[k * n + j];
+				a[k * n + j] = a[pivot_row * n + j];
+				a[pivot_row * n + j] = temp_entry;
+			}
+			int temp_ind = perm[k];
+			perm[k] = perm[pivot_row];
+			perm[pivot_row] = temp_ind;
+		}
+		const double *restrict k_row = a + k * n;
+		for (int i=k+1; i<n; i++) {
+			double *restrict i_row = a + i * n;
+			double l_entry = i_row[k] / k_row[k];
+			i_row[k] = l_entry;
+			for (int j=k+1; j<n; j++)
+				i_row[j] -= l_entry * k_row[j];
+		}
+	}
+	
+	return 1;
+}
+
+// solves ax = b in double precision given the factorization from double_lu_factor
+// b is read in extended precision and the result is written to x
+// runtime: O(n^2)
+static void double_lu_solve(double *lu, int n, int *perm, vector b, double *x) {
+	for (int i=0; i<n; i++) {
+		double sum = (double) b[perm[i]];
+		for (int j=0; j<i; j++)
+			sum -= lu[i * n + j] * x[j];
+		x[i] = sum;
+	}
+	for (int i=n-1; i>=0; i--) {
+		double sum = x[i];
+		for (int j=i+1; j<n; j++)
+			sum -= lu[i * n + j] * x[j];
+		x[i] = sum / lu[i * n + i];
+	}
+}
+
+// bounds the relative error of x as a solution of ax = b, from the residual b - ax computed in extended precision
+// the correction lu_solve finds from the residual is added to the rounding error of the residual itself,
+// up to n*MATRIX_ENTRY_EPS*(|a||x| + |b|) in each entry, carried through |a^-1| so that its signs cannot cancel
+// runtime: O(n^3), to form the columns of a^-1
+static matrix_entry residual_error_bound(matrix a, matrix lu, int *perm, vector b, vector x) {
+	int n = a.m;
+	vector residual = (vector) malloc(sizeof(matrix_entry) * n);
+	vector rounding = (vector) malloc(sizeof(matrix_entry) * n);
+	vector error = (vector) malloc(sizeof(matrix_entry) * n);
+	vector column = (vector) malloc(sizeof(matrix_entry) * n);
+	for (int i=0; i<n; i++) {
+		matrix_entry sum = b[i], magnitude = fabs(b[i]);
+		for (int j=0; j<n; j++) {
+			sum -= a.entries[i][j] * x[j];
+			magnitude += fabs(a.entries[i][j] * x[j]);
+		}
+		residual[i] = sum;
+		rounding[i] = n * MATRIX_ENTRY_EPS * magnitude;
+	}
+	lu_solve(lu, perm, residual, error);
+	for (int i=0; i<n; i++)
+		error[i] = fabs(error[i]);
+	// column k of a^-1 solves ax = e_k, and residual is reused to hold e_k
+	for (int k=0; k<n; k++) {
+		for (int i=0; i<n; i++)
+			residual[i] = (i == k) ? 1 : 0;
+		lu_solve(lu, perm, residual, column);
+		for (int i=0; i<n; i++)
+			error[i] += fabs(column[i]) * rounding[k];
+	}
+	matrix_entry error_norm = 0, x_norm = 0;
+	for (int i=0; i<n; i++) {
+		if (error[i] > error_norm)
+			error_norm = error[i];
+		if (fabs(x[i]) > x_norm)
+			x_norm = fabs(x[i]);
+	}
+	free(residual);
+	free(rounding);
+	free(error);
+	free(column);
+	
+	return (x_norm == 0) ? error_norm : error_norm / x_norm;
+}
+
+// solves ax = b by mixed-precision iterative refinement
+// a is factored in hardware double, then the solution is corrected using residuals computed as matrix_entry
+// until the corrections fall below the precision of matrix_entry
+// error_bound is set to the estimated relative error of the result (the size of the last correction)
+// if the refinement does not converge, falls back to extended-precision LU, as in solve_linear_system,
+// and error_bound is set by residual_error_bound for the better of the stalled refined solution and the LU solution
+// runtime: O(n^3) in double precision, then O(n^2) in extended precision per iteration, plus O(n^3) in extended precision to fall back
+vector refined_solve(matrix a, vector b, matrix_entry *error_bound) {
+	assert(a.m == a.n);	// only defined for square matrices
+	int n = a.m;
+	double *lu = (double*) malloc(sizeof(double) * n * n);
+	int *perm = (int*) malloc(sizeof(int) * n);
+	for (int i=0; i<n; i++) {
+		for (int j=0; j<n; j++)
+			lu[i * n + j] = (double) a.entries[i][j];
+	}
+	vector result = NULL;
+	if (double_lu_factor(lu, n, perm)) {
+		result = (vector) malloc(sizeof(matrix_entry) * n);
+		vector residual = (vector) malloc(sizeof(matrix_entry) * n);
+		double *correction = (double*) malloc(sizeof(double) * n);
+		double_lu_solve(lu, n, perm, b, correction);
+		for (int i=0; i<n; i++)
+			result[i] = correction[i];
+		matrix_entry prev_correction_norm = HUGE_VAL;
+		int converged = 0;
+		for (int iter=0; iter<MAX_REFINE_ITER; iter++) {
+			// compute the residual b - ax in extended precision
+			for (int i=0; i<n; i++) {
+				matrix_entry sum = b[i];
+				const matrix_entry *restrict a_row = a.entries[i];
+				for (int j=0; j<n; j++)
+					sum -= a_row[j] * result[j];
+				residual[i] = sum;
+			}
+			// solve for the correction in double precision
+			double_lu_solve(lu, n, perm, residual, correction);
+			matrix_entry correction_norm = 0, result_norm = 0;
+			for (int i=0; i<n; i++) {
+				result[i] += correction[i];
+				if (fabs(correction[i]) > correction_norm)
+					correction_norm = fabs(correction[i]);
+				if (fabs(result[i]) > result_norm)
+					result_norm = fabs(result[i]);
+			}
+			*error_bound = (result_norm == 0) ? correction_norm : correction_norm / result_norm;
+			if (*error_bound <= n * MATRIX_ENTRY_EPS) {
+				converged = 1;
+				break;
+			}
+			// stop if the corrections are not shrinking, as a is too ill-conditioned for double precision
+			if (correction_norm > prev_correction_norm / 2)
+				break;
+			prev_correction_norm = correction_norm;
+		}
+		free(residual);
+		free(correction);
+		if (converged) {
+			free(lu);
+			free(perm);
+			return result;
+		}
+	}
+	free(lu);
+	
+	// the refinement stalled, or a is singular in double precision, so a is factored in extended precision instead
+	matrix *ext_lu = copy_matrix(a);
+	lu_factor(*ext_lu, perm);
+	vector ext_result = (vector) malloc(sizeof(matrix_entry) * n);
+	lu_solve(*ext_lu, perm, b, ext_result);
+	*error_bound = residual_error_bound(a, *ext_lu, perm, b, ext_result);
+	if (result != NULL) {
+		matrix_entry refined_error = residual_error_bound(a, *ext_lu, perm, b, result);
+		if (refined_error < *error_bound) {
+			*error_bound = refined_error;
+			free(ext_result);
+			ext_result = result;
+		} else {
+			free(result);
+		}
+	}
+	free_matrix(ext_lu);
+	free(perm);
+	
+	return ext_result;
+}
+
 /* ---------- Input / Output ---------- */
 
 // prints a matrix to stdout
@@ -299,16 +786,18 @@ void print_matrix(matrix a) {
  *  0  0
  *  5  0
  * ineff_det: -10
- * eff_det: 10 
+ * eff_det: -10
+ * integer_det: -10
  * lu decomposition is not unique, output can be checked manually
+ * with partial pivoting, rows 0 and 2 are exchanged, giving:
  * invert_lower_tri_matrix: 
  * 1.000000 0.000000 0.000000 
  * 0.000000 1.000000 0.000000 
- * -1.666667 -0.833333 1.000000 
+ * -0.600000 0.500000 1.000000 
  * invert_upper_tri_matrix: 
- * 0.333333 0.166667 0.200000 
- * 0.000000 -0.500000 0.000000 
- * 0.000000 -0.000000 0.600000 
+ * 0.200000 0.000000 0.000000 
+ * 0.000000 -0.500000 -0.000000 
+ * 0.000000 0.000000 -1.000000 
  * invert_matrix: 
  * 0.000000 0.000000 0.200000 
  * 0.000000 -0.500000 0.000000 
@@ -327,6 +816,7 @@ void test_matrix_functions() {
 	print_matrix(*matrix_minor(*a, 1));
 	printf("ineff_det: %lf\n", (double) ineff_det(*a));
 	printf("eff_det: %lf\n", (double) eff_det(*a));
+	printf("integer_det: %lf\n", (double) integer_det(*a));
 	matrix *a_cpy = copy_matrix(*a);
 	printf("lu_decomp: \n");
 	matrix **pl = lu_decomp(a_cpy, (int*) NULL);
@@ -341,8 +831,85 @@ void test_matrix_functions() {
 	print_matrix(*invert_matrix(*a));
 }
 
+// exercises the blocked algorithms on a matrix larger than MATRIX_BLOCK
+// should output 1, 1, 1, 1, 1
+// then 1, 1, as refined_solve falls back to extended-precision LU on a hilbert matrix, and bounds the error of the result
+void test_blocked_functions() {
+	int n = 6 * MATRIX_BLOCK + 5;	// large enough to take the parallel paths
+	set_num_workers(4);
+	matrix *a = alloc_matrix(n, n);
+	for (int i=0; i<n; i++) {
+		for (int j=0; j<n; j++)
+			a->entries[i][j] = (matrix_entry) ((i * 7 + j * 13) % 17 - 8) + ((i == j) ? 1 : 0);
+	}
+	matrix *a_inv = invert_matrix(*a);
+	matrix *product = matrix_mult(*a, *a_inv);
+	matrix_entry max_err = 0;
+	for (int i=0; i<n; i++) {
+		for (int j=0; j<n; j++) {
+			matrix_entry err = product->entries[i][j] - ((i == j) ? 1 : 0);
+			if (fabs(err) > max_err)
+				max_err = fabs(err);
+		}
+	}
+	printf("blocked invert_matrix: %d\n", max_err < 1e-20);
+	matrix_entry exact = integer_det(*a), approx = eff_det(*a);
+	printf("blocked eff_det: %d\n", fabs((approx - exact) / exact) < 1e-20);
+	vector b = (vector) malloc(sizeof(matrix_entry) * n);
+	for (int i=0; i<n; i++)
+		b[i] = i;
+	vector x = solve_linear_system(*a, b), ax = matrix_eval(*a, x);
+	max_err = 0;
+	for (int i=0; i<n; i++) {
+		if (fabs(ax[i] - b[i]) > max_err)
+			max_err = fabs(ax[i] - b[i]);
+	}
+	printf("solve_linear_system: %d\n", max_err < 1e-20);
+	free(x);
+	free(ax);
+	matrix_entry error_bound;
+	x = refined_solve(*a, b, &error_bound);
+	ax = matrix_eval(*a, x);
+	max_err = 0;
+	for (int i=0; i<n; i++) {
+		if (fabs(ax[i] - b[i]) > max_err)
+			max_err = fabs(ax[i] - b[i]);
+	}
+	printf("refined_solve: %d, %d\n", max_err < 1e-25, error_bound < 1e-30);
+	free(b);
+	free(x);
+	free(ax);
+	free_matrix(a);
+	free_matrix(a_inv);
+	free_matrix(product);
+	// the refinement stalls short of full precision on the hilbert matrix, so it falls back to extended-precision LU
+	// scaled by lcm(1, ..., 19) so its entries are exact, its solution for b = lcm(1, ..., 19) is the integer row sums of its inverse
+	n = 10;
+	a = alloc_matrix(n, n);
+	b = (vector) malloc(sizeof(matrix_entry) * n);
+	for (int i=0; i<n; i++) {
+		for (int j=0; j<n; j++)
+			a->entries[i][j] = 232792560 / (i + j + 1);
+		b[i] = 232792560;
+	}
+	x = refined_solve(*a, b, &error_bound);
+	matrix_entry err = 0, x_norm = 0;
+	for (int i=0; i<n; i++) {
+		matrix_entry nearest = (matrix_entry) (long long) (x[i] + ((x[i] < 0) ? -0.5Q : 0.5Q));
+		if (fabs(x[i] - nearest) > err)
+			err = fabs(x[i] - nearest);
+		if (fabs(x[i]) > x_norm)
+			x_norm = fabs(x[i]);
+	}
+	printf("refined_solve fallback: %d, %d\n", error_bound < 1e-18, err / x_norm <= error_bound);
+	free(b);
+	free(x);
+	free_matrix(a);
+}
+
 int main(int argc, char **argv) {
 	test_matrix_functions();
+	test_blocked_functions();
 	exit(0);
 }
 
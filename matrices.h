@@ -7,9 +7,12 @@
 
 typedef matrix_entry* vector;
 
+// the entries are stored contiguously in row-major order, with each row aligned
 typedef struct matrix {
 	int m, n;	// m rows, n columns
-	vector *entries;	// entries[i] is ith row
+	int stride;	// distance between the starts of consecutive rows
+	matrix_entry *data;	// the buffer holding all entries
+	vector *entries;	// entries[i] is ith row, i.e. data + i*stride
 } matrix;
 
 matrix *alloc_matrix(int, int);
@@ -22,10 +25,18 @@ matrix *identity_matrix(int);
 
 vector matrix_eval(matrix, vector);
 
+matrix *matrix_mult(matrix, matrix);
+
 matrix_entry det(matrix);
 
+matrix_entry integer_det(matrix);
+
 matrix *invert_matrix(matrix);
 
+vector solve_linear_system(matrix, vector);
+
+vector refined_solve(matrix, vector, matrix_entry *);
+
 void print_matrix(matrix);
 
 #endif
@@ -1,12 +1,25 @@
 // minpoly.c
-// finds the minimal polynomial of a low-degree real algebraic number
+// finds the minimal polynomial of a real algebraic number from an approximation
+// by default an integer relation among the powers of the number is found by lattice reduction,
+// and the original reduction to subset sum is kept for comparison
 
 #include "minpoly.h"
 #include "subset_sum.h"
+#include "integers.h"
+#include "lll.h"
+#include "threads.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 #include <assert.h>
 #include <math.h>
+#include <float.h>
+#include <pthread.h>
+
+// most memory in bytes the subset sum searches of concurrently searched degrees may hold at once
+#define MAX_SEARCH_MEMORY ((size_t) 1 << 30)
+// largest scale of the relation lattice, so that its rounded entries stay exact in matrix_entry
+#define MAX_RELATION_SCALE 0x1p100Q
 
 // computes integer powers of 2
 static int pow2(int n) {
@@ -74,16 +87,21 @@ static polynomial *subset_to_polynomial(subset_sum_problem problem, int k, int *
 	return result;
 }
 
+/* ---------- Subset Sum Search ---------- */
+
 // given a ball b and ints max_k and max_deg
 // searches for a minimal polynomial with coefficients bounded by 2^{max_k-1} for an element the ball b by increasing k to max_k and degree to max_deg
+// if external is 1, the subset sum problems are solved out of core, and the search fails if that is not possible
 // returns the polynomial found or NULL on failure
 // NOTE: only works for positive values of b.center
-static polynomial *get_min_poly_pos(ball b, int max_k, int max_deg) {
+static polynomial *get_min_poly_pos(ball b, int max_k, int max_deg, int external) {
 	root_type error;
 	polynomial *min_poly;
 	for (int i=1; i<=max_deg; i++) {
 		subset_sum_problem problem = *to_subset_sum(b.center, max_k, i);
-		int *subset = subset_sum_certificate(problem, &error);
+		int *subset = external ? external_subset_sum_certificate(problem, &error) : subset_sum_certificate(problem, &error);
+		if (subset == NULL)
+			return NULL;
 		min_poly = subset_to_polynomial(problem, max_k, subset);
 		// test if b.center is a root of min_poly
 		if (test_for_root(*min_poly, b))
@@ -93,25 +111,398 @@ static polynomial *get_min_poly_pos(ball b, int max_k, int max_deg) {
 	return NULL;	// indicates failure
 }
 
+// the degrees searched concurrently by get_min_poly_pos_concurrent
+typedef struct degree_job {
+	ball b;
+	int max_k, max_deg;
+	polynomial **results;	// by degree, NULL where no polynomial was found
+	int *cancelled;			// by degree, set once a lower degree has found a polynomial
+	size_t memory_used;		// by the searches which are running
+	int num_running;
+	pthread_mutex_t lock;
+	pthread_cond_t memory_freed;
+} degree_job;
+
+// searches for a polynomial of degree task + 1 as get_min_poly_pos does
+// the search waits until its sorted sums fit in MAX_SEARCH_MEMORY next to those of the running searches,
+// and gives up as soon as a lower degree finds a polynomial
+static void degree_task(int task, int worker, void *arg) {
+	degree_job *job = (degree_job*) arg;
+	int deg = task + 1;
+	subset_sum_problem problem = *to_subset_sum(job->b.center, job->max_k, deg);
+	size_t memory = subset_sum_memory(problem.size);
+	pthread_mutex_lock(&job->lock);
+	while (!job->cancelled[deg] && (job->num_running > 0) && (job->memory_used + memory > MAX_SEARCH_MEMORY))
+		pthread_cond_wait(&job->memory_freed, &job->lock);
+	int admitted = !job->cancelled[deg];
+	if (admitted) {
+		job->memory_used += memory;
+		job->num_running++;
+	}
+	pthread_mutex_unlock(&job->lock);
+	if (!admitted) {
+		free(problem.items);
+		return;
+	}
+	
+	root_type error;
+	int *subset = cancellable_subset_sum_certificate(problem, &error, &job->cancelled[deg]);
+	polynomial *min_poly = NULL;
+	if (subset != NULL) {
+		min_poly = subset_to_polynomial(problem, job->max_k, subset);
+		if (!test_for_root(*min_poly, job->b)) {
+			free_polynomial(min_poly);
+			min_poly = NULL;
+		}
+		free(subset);
+	}
+	pthread_mutex_lock(&job->lock);
+	if (min_poly != NULL) {
+		job->results[deg] = min_poly;
+		// the lowest degree wins, so the searches of higher degrees are no longer needed
+		for (int d=deg+1; d<=job->max_deg; d++)
+			__atomic_store_n(&job->cancelled[d], 1, __ATOMIC_RELAXED);
+	}
+	job->memory_used -= memory;
+	job->num_running--;
+	pthread_cond_broadcast(&job->memory_freed);
+	pthread_mutex_unlock(&job->lock);
+	free(problem.items);
+}
+
+// same as get_min_poly_pos, but the degrees are searched concurrently by the worker threads, lowest first
+// a search is cancelled once a lower degree finds a polynomial, and searches wait for memory to start
+static polynomial *get_min_poly_pos_concurrent(ball b, int max_k, int max_deg) {
+	degree_job job;
+	job.b = b;
+	job.max_k = max_k;
+	job.max_deg = max_deg;
+	job.results = (polynomial**) calloc(max_deg + 1, sizeof(polynomial*));
+	job.cancelled = (int*) calloc(max_deg + 1, sizeof(int));
+	job.memory_used = 0;
+	job.num_running = 0;
+	pthread_mutex_init(&job.lock, NULL);
+	pthread_cond_init(&job.memory_freed, NULL);
+	parallel_for(max_deg, degree_task, &job);
+	pthread_mutex_destroy(&job.lock);
+	pthread_cond_destroy(&job.memory_freed);
+	
+	polynomial *result = NULL;
+	for (int deg=1; deg<=max_deg; deg++) {
+		if (result == NULL) {
+			result = job.results[deg];
+		} else if (job.results[deg] != NULL) {
+			free_polynomial(job.results[deg]);
+		}
+	}
+	free(job.results);
+	free(job.cancelled);
+	return result;
+}
+
 // extends get_min_poly_pos to all real values of b.center
 // also handles the case where b contains 1
-polynomial *get_min_poly(ball b, int max_k, int max_deg) {
+// the degrees are searched concurrently if concurrent is 1, and otherwise in order, out of core if external is 1
+static polynomial *min_poly_subset_sum(ball b, int max_k, int max_deg, int concurrent, int external) {
 	if (test_ball_membership(1, b)) {
 		polynomial *result = alloc_polynomial(1);
 		result->coefficients[0] = 1;
 		result->coefficients[1] = -1;	
 		return result;
 	}
-	if (b.center > 0)
-		return get_min_poly_pos(b, max_k, max_deg);
-	b.center *= -1;
-	polynomial *temp = get_min_poly_pos(b, max_k, max_deg);
-	polynomial *result = linear_change_of_variables(*temp, -1, 0);
-	free_polynomial(temp);
+	int negated = (b.center <= 0);
+	if (negated)
+		b.center *= -1;
+	polynomial *result = concurrent ? get_min_poly_pos_concurrent(b, max_k, max_deg) : get_min_poly_pos(b, max_k, max_deg, external);
+	if (negated && (result != NULL)) {
+		polynomial *temp = result;
+		result = linear_change_of_variables(*temp, -1, 0);
+		free_polynomial(temp);
+	}
 	
 	return result;
 }
 
+// runtime: exponential in max_k * max_deg
+polynomial *get_min_poly_subset_sum(ball b, int max_k, int max_deg) {
+	return min_poly_subset_sum(b, max_k, max_deg, 0, 0);
+}
+
+// same as get_min_poly_subset_sum, but the degrees are searched concurrently
+// the lowest degree found wins, so the result is the same, but most of the time goes to the largest degree tried,
+// whose sorted sums are then built by a single thread
+polynomial *get_min_poly_subset_sum_concurrent(ball b, int max_k, int max_deg) {
+	return min_poly_subset_sum(b, max_k, max_deg, 1, 0);
+}
+
+// same as get_min_poly_subset_sum, but the sorted sums of each search are kept in temporary files on disk
+// this reaches problems whose sorted sums do not fit in memory, of up to 60 items, and returns NULL if the files cannot be made
+polynomial *get_min_poly_subset_sum_external(ball b, int max_k, int max_deg) {
+	return min_poly_subset_sum(b, max_k, max_deg, 0, 1);
+}
+
+/* ---------- Branch and Bound Search ---------- */
+
+// largest number of sums of low degree terms kept sorted by the branch and bound search
+#define MAX_LOWER_SUMS (1 << 22)
+
+// the state of the branch and bound search for a polynomial of degree deg vanishing near x
+// the terms of degree below num_lower are combined through a sorted list of their sums,
+// and the higher coefficients are chosen by a depth first search from the leading one down
+typedef struct bound_search {
+	ball b;
+	int deg, bound;				// coefficients are in [-bound, bound]
+	root_type *powers;			// powers of b.center up to deg
+	partial_sum *lower;			// sums of the low degree terms, whose masks encode their coefficients in base 2*bound+1
+	int num_lower, num_lower_sums;
+	root_type *slack;			// slack[d] bounds the sum of the terms of degree in [num_lower, d)
+	int *coefficients;			// by degree, as the search sets them
+	int *best;					// coefficients of the polynomial closest to vanishing so far
+	root_type best_err;
+	root_type stop_err;			// a polynomial with a root in b is about at most this far from 0 at b.center
+	polynomial *found;
+} bound_search;
+
+// divides p by the gcd of its coefficients
+static void divide_content(polynomial *p) {
+	int content = 0;
+	for (int i=0; i<=p->deg; i++) {
+		content = gcd(p->coefficients[i], content);
+	}
+	for (int i=0; (i<=p->deg) && (content != 0); i++) {
+		p->coefficients[i] /= abs(content);
+	}
+}
+
+// returns the primitive polynomial with coefficients given by degree
+static polynomial *coefficients_to_polynomial(int *coefficients, int deg) {
+	polynomial *result = alloc_polynomial(deg);
+	for (int i=0; i<=deg; i++) {
+		result->coefficients[deg - i] = coefficients[i];
+	}
+	divide_content(result);
+	
+	return result;
+}
+
+// extends the sorted sums of the low degree terms by the term of degree num_lower
+// the sums found for lower degrees are reused, and only the combinations with the new term are added and sorted
+static void add_lower_term(bound_search *s) {
+	int width = 2 * s->bound + 1;
+	uint64_t place = 1;
+	for (int i=0; i<s->num_lower; i++) {
+		place *= width;
+	}
+	partial_sum *lower = (partial_sum*) malloc(sizeof(partial_sum) * s->num_lower_sums * width);
+	assert(lower != NULL);
+	for (int c=-s->bound; c<=s->bound; c++) {
+		partial_sum *shifted = lower + (c + s->bound) * s->num_lower_sums;
+		for (int j=0; j<s->num_lower_sums; j++) {
+			shifted[j].sum = s->lower[j].sum + c * s->powers[s->num_lower];
+			shifted[j].mask = s->lower[j].mask + (c + s->bound) * place;
+		}
+	}
+	free(s->lower);
+	s->lower = lower;
+	s->num_lower_sums *= width;
+	s->num_lower++;
+	sort_sums(s->lower, s->num_lower_sums);
+}
+
+// completes the coefficients with the low degree terms closest to cancelling partial
+// if they bring the polynomial closer to vanishing than the best so far, it becomes the best,
+// and if it is within stop_err of vanishing it is tested for a root in b
+static void search_lower(bound_search *s, root_type partial) {
+	// the last sum not above -partial, and the one after it, are the closest
+	int low = -1, high = s->num_lower_sums - 1;
+	while (low < high) {
+		int mid = high - (high - low) / 2;
+		if (partial + s->lower[mid].sum <= 0) {
+			low = mid;
+		} else {
+			high = mid - 1;
+		}
+	}
+	for (int j=low; j<=low+1; j++) {
+		if ((j < 0) || (j >= s->num_lower_sums) || (fabs(partial + s->lower[j].sum) >= s->best_err))
+			continue;
+		s->best_err = fabs(partial + s->lower[j].sum);
+		uint64_t mask = s->lower[j].mask;
+		for (int i=0; i<s->num_lower; i++) {
+			s->best[i] = (int) (mask % (2 * s->bound + 1)) - s->bound;
+			mask /= 2 * s->bound + 1;
+		}
+		for (int i=s->num_lower; i<=s->deg; i++) {
+			s->best[i] = s->coefficients[i];
+		}
+		if (s->best_err <= s->stop_err) {
+			polynomial *candidate = coefficients_to_polynomial(s->best, s->deg);
+			if (test_for_root(*candidate, s->b)) {
+				s->found = candidate;
+				return;
+			}
+			free_polynomial(candidate);
+		}
+	}
+}
+
+// chooses the coefficient of degree d, given the sum partial of the terms of higher degree
+// only coefficients which leave partial within reach of the remaining terms, and of the best error so far, are tried
+static void search_terms(bound_search *s, int d, root_type partial) {
+	if (d < s->num_lower) {
+		search_lower(s, partial);
+		return;
+	}
+	// c*x^d + partial must be within reach of 0 by the remaining terms
+	root_type reach = s->slack[d] + s->best_err;
+	root_type low = (-partial - s->lower[s->num_lower_sums - 1].sum - reach) / s->powers[d];
+	root_type high = (-partial - s->lower[0].sum + reach) / s->powers[d];
+	if (s->powers[d] < 0) {
+		root_type temp = low;
+		low = high;
+		high = temp;
+	}
+	// the leading coefficient is positive, so that each polynomial is searched once up to sign
+	root_type min_c = (d == s->deg) ? 1 : -s->bound;
+	low = (ceil(low) > min_c) ? ceil(low) : min_c;
+	high = (floor(high) < s->bound) ? floor(high) : s->bound;
+	for (int c=(int) low; (c<=(int) high) && (s->found == NULL); c++) {
+		s->coefficients[d] = c;
+		search_terms(s, d - 1, partial + c * s->powers[d]);
+	}
+}
+
+// given a ball b and ints max_k and max_deg
+// searches for the polynomial of least degree up to max_deg with coefficients bounded by 2^{max_k-1} with a root in b,
+// taking for each degree the polynomial closest to vanishing at b.center
+// the search stops as soon as it finds a polynomial close enough to vanishing to have a root in b,
+// and the sorted sums of the low degree terms are kept from one degree to the next
+// returns the polynomial found or NULL on failure, including when the 2^max_k + 1 choices of a coefficient exceed MAX_LOWER_SUMS
+// runtime: exponential in max_k * max_deg, but subtrees which cannot improve on the best polynomial are skipped
+polynomial *get_min_poly_branch_and_bound(ball b, int max_k, int max_deg) {
+	// the choices of even a single low degree term must fit in the sorted sums, which also keeps them within an int
+	if ((max_k < 1) || (max_k > 30) || (2 * pow2(max_k - 1) + 1 > MAX_LOWER_SUMS))
+		return NULL;
+	bound_search s;
+	s.b = b;
+	s.bound = pow2(max_k - 1);
+	s.powers = (root_type*) malloc(sizeof(root_type) * (max_deg + 1));
+	s.slack = (root_type*) malloc(sizeof(root_type) * (max_deg + 1));
+	s.coefficients = (int*) malloc(sizeof(int) * (max_deg + 1));
+	s.best = (int*) malloc(sizeof(int) * (max_deg + 1));
+	s.powers[0] = 1;
+	for (int i=1; i<=max_deg; i++) {
+		s.powers[i] = s.powers[i - 1] * b.center;
+	}
+	s.lower = (partial_sum*) malloc(sizeof(partial_sum));
+	s.lower[0].sum = 0;
+	s.lower[0].mask = 0;
+	s.num_lower = 0;
+	s.num_lower_sums = 1;
+	s.found = NULL;
+	
+	for (s.deg=1; (s.deg<=max_deg) && (s.found == NULL); s.deg++) {
+		// about half the terms are combined through the sorted sums, as far as memory allows
+		while ((s.num_lower < (s.deg + 1) / 2) && ((long long) s.num_lower_sums * (2 * s.bound + 1) <= MAX_LOWER_SUMS))
+			add_lower_term(&s);
+		// the first term always fits, as max_k was checked above
+		if (s.num_lower == 0)
+			add_lower_term(&s);
+		s.slack[s.num_lower] = 0;
+		for (int d=s.num_lower+1; d<=s.deg; d++) {
+			s.slack[d] = s.slack[d - 1] + s.bound * fabs(s.powers[d - 1]);
+		}
+		// moving b.center by b.radius moves a polynomial by about its derivative times b.radius
+		s.stop_err = 0;
+		for (int i=1; i<=s.deg; i++) {
+			s.stop_err += i * s.bound * pow(fabs(b.center) + b.radius, i - 1);
+		}
+		s.stop_err *= b.radius;
+		s.best_err = DBL_MAX;
+		search_terms(&s, s.deg, 0);
+		// as in the subset sum search, the polynomial closest to vanishing is tested even if it was not within stop_err
+		if ((s.found == NULL) && (s.best_err > s.stop_err) && (s.best_err < DBL_MAX)) {
+			polynomial *candidate = coefficients_to_polynomial(s.best, s.deg);
+			if (test_for_root(*candidate, b)) {
+				s.found = candidate;
+			} else {
+				free_polynomial(candidate);
+			}
+		}
+	}
+	
+	free(s.powers);
+	free(s.slack);
+	free(s.coefficients);
+	free(s.best);
+	free(s.lower);
+	return s.found;
+}
+
+/* ---------- Integer Relation Search ---------- */
+
+// searches for a polynomial of degree deg with coefficients at most 2^{max_k-1} in absolute value with a root in b
+// the powers 1, x, ..., x^deg of the center are scaled so that the error the radius allows in a combination of them
+// is about 1, and a short integer relation among them is found by lattice reduction
+// returns a primitive polynomial with positive leading coefficient, or NULL if none is found
+static polynomial *relation_of_degree(ball b, int max_k, int deg) {
+	matrix_entry x = b.center, abs_x = fabs(b.center), max_power = 1;
+	for (int i=0; i<deg; i++) {
+		if (abs_x > 1)
+			max_power *= abs_x;
+	}
+	// moving x by the radius moves x^i by up to i*|x|^(i-1)*radius
+	matrix_entry scale = MAX_RELATION_SCALE / max_power;
+	if ((b.radius > 0) && (1 / (b.radius * deg * max_power) < scale))
+		scale = 1 / (b.radius * deg * max_power);
+	matrix_entry *powers = (matrix_entry*) malloc(sizeof(matrix_entry) * (deg + 1));
+	matrix_entry *relation = (matrix_entry*) malloc(sizeof(matrix_entry) * (deg + 1));
+	powers[0] = 1;
+	for (int i=1; i<=deg; i++) {
+		powers[i] = powers[i - 1] * x;
+	}
+	matrix_entry bound = (max_k > 31) ? INT_MAX : (matrix_entry) (1LL << (max_k - 1));
+	polynomial *result = NULL;
+	if (find_integer_relation(powers, deg + 1, scale, relation) && (relation[deg] != 0)) {
+		result = alloc_polynomial(deg);
+		int sign = (relation[deg] < 0) ? -1 : 1;
+		for (int i=0; (i<=deg) && (result != NULL); i++) {
+			matrix_entry coefficient = sign * relation[deg - i];
+			if ((coefficient > bound) || (coefficient < -bound)) {
+				free_polynomial(result);
+				result = NULL;
+			} else {
+				result->coefficients[i] = (int) coefficient;
+			}
+		}
+		if (result != NULL)
+			divide_content(result);
+	}
+	free(powers);
+	free(relation);
+	if ((result != NULL) && !test_for_root(*result, b)) {
+		free_polynomial(result);
+		result = NULL;
+	}
+
+	return result;
+}
+
+// given a ball b and ints max_k and max_deg
+// searches for the polynomial of least degree up to max_deg with coefficients bounded by 2^{max_k-1} with a root in b
+// each degree takes a lattice reduction in dimension deg + 1, so large degrees and heights are practical
+// as long as the radius of b is small enough to determine the relation
+// returns the polynomial found or NULL on failure
+// runtime: polynomial in max_deg and max_k
+polynomial *get_min_poly(ball b, int max_k, int max_deg) {
+	polynomial *result = NULL;
+	for (int deg=1; (deg<=max_deg) && (result == NULL); deg++) {
+		result = relation_of_degree(b, max_k, deg);
+	}
+
+	return result;
+}
+
 /* ---------- Testing ---------- */
 // to test, run "make test minpoly"
 
@@ -120,6 +511,10 @@ polynomial *get_min_poly(ball b, int max_k, int max_deg) {
 #define ROOT_2_ERR 1e-15
 #define DEG5_ALG -1.1673039782614186843
 #define DEG5_ERR 1e-10
+#define SQRT2_SQRT3 3.1462643699419726
+#define SQRT2_SQRT3_ERR 1e-15
+#define SQRT2_CBRT3 2.8564631326805037
+#define SQRT2_CBRT3_ERR 1e-15
 
 // should output a sum of 7+4sqrt(2)
 // then 1, 2, 4, sqrt(2), 2sqrt(2), 4sqrt(2), 2, 4, 8
@@ -145,22 +540,69 @@ void test_subset_to_polynomial() {
 }
 
 // should output -x^2 + 2 and x^5 - x + 1
-void test_get_min_poly() {
+void test_get_min_poly_subset_sum() {
 	ball *root_2_ball = (ball*) malloc(sizeof(ball));
 	root_2_ball->center = ROOT_2;
 	root_2_ball->radius = ROOT_2_ERR;
 	printf("min_poly for sqrt(2): ");
-	print_polynomial(*get_min_poly(*root_2_ball, 3, 2));
+	print_polynomial(*get_min_poly_subset_sum(*root_2_ball, 3, 2));
 	ball *deg5_alg_ball = (ball*) malloc(sizeof(ball));
 	deg5_alg_ball->center = DEG5_ALG;
 	deg5_alg_ball->radius = DEG5_ERR;
 	printf("min_poly for degree 5 algebraic: ");
-	print_polynomial(*get_min_poly(*deg5_alg_ball, 3, 5));
+	print_polynomial(*get_min_poly_subset_sum(*deg5_alg_ball, 3, 5));
+}
+
+// should output -x^2 + 2 and x^5 - x + 1, as test_get_min_poly_subset_sum does
+void test_get_min_poly_subset_sum_concurrent() {
+	set_num_workers(4);
+	printf("min_poly for sqrt(2): ");
+	print_polynomial(*get_min_poly_subset_sum_concurrent(*new_ball(ROOT_2, ROOT_2_ERR), 3, 2));
+	printf("min_poly for degree 5 algebraic: ");
+	print_polynomial(*get_min_poly_subset_sum_concurrent(*new_ball(DEG5_ALG, DEG5_ERR), 3, 5));
+	set_num_workers(0);
+}
+
+// should output -x^2 + 2 and x^5 - x + 1, as test_get_min_poly_subset_sum does
+void test_get_min_poly_subset_sum_external() {
+	printf("min_poly for sqrt(2): ");
+	print_polynomial(*get_min_poly_subset_sum_external(*new_ball(ROOT_2, ROOT_2_ERR), 3, 2));
+	printf("min_poly for degree 5 algebraic: ");
+	print_polynomial(*get_min_poly_subset_sum_external(*new_ball(DEG5_ALG, DEG5_ERR), 3, 5));
+}
+
+// should output x^2 - 2, x^5 - x + 1 and x^4 - 10x^2 + 1, then 1
+void test_get_min_poly_branch_and_bound() {
+	printf("min_poly for sqrt(2): ");
+	print_polynomial(*get_min_poly_branch_and_bound(*new_ball(ROOT_2, ROOT_2_ERR), 3, 2));
+	printf("min_poly for degree 5 algebraic: ");
+	print_polynomial(*get_min_poly_branch_and_bound(*new_ball(DEG5_ALG, DEG5_ERR), 3, 5));
+	// the subset sum search would need 2^15-sized lists for each degree
+	printf("min_poly for sqrt(2) + sqrt(3): ");
+	print_polynomial(*get_min_poly_branch_and_bound(*new_ball(SQRT2_SQRT3, SQRT2_SQRT3_ERR), 5, 5));
+	// 2^22 + 1 choices of a coefficient do not fit in MAX_LOWER_SUMS, and 2^32 + 1 do not fit in an int
+	printf("rejects large max_k: %d\n", (get_min_poly_branch_and_bound(*new_ball(ROOT_2, ROOT_2_ERR), 22, 2) == NULL)
+			&& (get_min_poly_branch_and_bound(*new_ball(ROOT_2, ROOT_2_ERR), 33, 2) == NULL));
+}
+
+// should output x^2 - 2, x^5 - x + 1 and x^6 - 6x^4 - 6x^3 + 12x^2 - 36x + 1
+void test_get_min_poly() {
+	printf("min_poly for sqrt(2): ");
+	print_polynomial(*get_min_poly(*new_ball(ROOT_2, ROOT_2_ERR), 3, 2));
+	printf("min_poly for degree 5 algebraic: ");
+	print_polynomial(*get_min_poly(*new_ball(DEG5_ALG, DEG5_ERR), 3, 5));
+	// sqrt(2) + cbrt(3) is out of reach of the subset sum search, which would need 2^21-sized lists
+	printf("min_poly for sqrt(2) + cbrt(3): ");
+	print_polynomial(*get_min_poly(*new_ball(SQRT2_CBRT3, SQRT2_CBRT3_ERR), 7, 6));
 }
 
 int main(int argc, char **argv) {
 	test_to_subset_sum();
 	test_subset_to_polynomial();
+	test_get_min_poly_subset_sum();
+	test_get_min_poly_subset_sum_concurrent();
+	test_get_min_poly_subset_sum_external();
+	test_get_min_poly_branch_and_bound();
 	test_get_min_poly();
 	exit(0);
 }
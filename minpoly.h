@@ -8,4 +8,12 @@
 
 polynomial *get_min_poly(ball, int, int);
 
+polynomial *get_min_poly_subset_sum(ball, int, int);
+
+polynomial *get_min_poly_subset_sum_concurrent(ball, int, int);
+
+polynomial *get_min_poly_subset_sum_external(ball, int, int);
+
+polynomial *get_min_poly_branch_and_bound(ball, int, int);
+
 #endif
@@ -0,0 +1,179 @@
+// modular.c
+// implements arithmetic modulo word-size primes and chinese remaindering
+
+#include "modular.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <math.h>
+
+// the largest primes below 2^63, in decreasing order
+static const uint64_t prime_table[NUM_MODULAR_PRIMES] = {
+	9223372036854775783ULL, 9223372036854775643ULL,
+	9223372036854775549ULL, 9223372036854775507ULL,
+	9223372036854775433ULL, 9223372036854775421ULL,
+	9223372036854775417ULL, 9223372036854775399ULL,
+	9223372036854775351ULL, 9223372036854775337ULL,
+	9223372036854775291ULL, 9223372036854775279ULL,
+	9223372036854775259ULL, 9223372036854775181ULL,
+	9223372036854775159ULL, 9223372036854775139ULL,
+	9223372036854775097ULL, 9223372036854775073ULL,
+	9223372036854775057ULL, 9223372036854774959ULL,
+	9223372036854774937ULL, 9223372036854774917ULL,
+	9223372036854774893ULL, 9223372036854774797ULL,
+	9223372036854774739ULL, 9223372036854774713ULL,
+	9223372036854774679ULL, 9223372036854774629ULL,
+	9223372036854774587ULL, 9223372036854774571ULL,
+	9223372036854774559ULL, 9223372036854774511ULL,
+};
+
+/* ---------- Constructors ---------- */
+
+// computes the montgomery constants for an odd modulus p < 2^63
+modulus init_modulus(uint64_t p) {
+	assert((p % 2 == 1) && (p < (1ULL << 63)));
+	modulus result;
+	result.p = p;
+	// newton's iteration doubles the number of correct bits of p^-1 mod 2^64 each step
+	uint64_t inv = p;
+	for (int i=0; i<5; i++)
+		inv *= 2 - p * inv;
+	result.p_inv = -inv;
+	uint64_t r = (-p) % p;	// 2^64 mod p
+	result.r2 = (uint64_t) (((unsigned __int128) r * r) % p);
+
+	return result;
+}
+
+// returns the ith prime of the table
+modulus modular_prime(int i) {
+	assert((i >= 0) && (i < NUM_MODULAR_PRIMES));
+	return init_modulus(prime_table[i]);
+}
+
+// returns the number of primes from the table needed to recover an integer of absolute value below 2^bits
+// one extra bit is reserved so that crt_reconstruct can determine the sign
+int primes_for_bits(double bits) {
+	int result = (int) ceil((bits + 2.0) / MODULAR_PRIME_BITS);
+	if (result < 1)
+		result = 1;
+	assert(result <= NUM_MODULAR_PRIMES);
+
+	return result;
+}
+
+/* ---------- Modular Arithmetic ---------- */
+
+// computes a^n mod p by repeated squaring
+// a and the result are in montgomery form
+uint64_t mod_pow(uint64_t a, uint64_t n, modulus m) {
+	uint64_t result = to_mod(1, m);
+	while (n > 0) {
+		if (n % 2 == 1)
+			result = mod_mult(result, a, m);
+		a = mod_mult(a, a, m);
+		n /= 2;
+	}
+
+	return result;
+}
+
+// uses fermat's little theorem, so a must be nonzero mod p
+uint64_t mod_inverse(uint64_t a, modulus m) {
+	assert(a != 0);
+	return mod_pow(a, m.p - 2, m);
+}
+
+/* ---------- Chinese Remaindering ---------- */
+
+// computes the mixed-radix digits of the residues modulo the first num_primes primes using garner's algorithm
+// the value is digits[0] + digits[1]*p_0 + digits[2]*p_0*p_1 + ...
+static void garner_digits(uint64_t *residues, int num_primes, uint64_t *digits) {
+	for (int i=0; i<num_primes; i++) {
+		modulus m = modular_prime(i);
+		// evaluate the digits found so far mod p_i using horner's scheme
+		uint64_t partial = 0, radix = to_mod(1, m);
+		for (int j=i-1; j>=0; j--) {
+			partial = mod_add(mod_mult(partial, to_mod(prime_table[j], m), m), to_mod(digits[j], m), m);
+		}
+		for (int j=0; j<i; j++) {
+			radix = mod_mult(radix, to_mod(prime_table[j], m), m);
+		}
+		uint64_t digit = mod_mult(mod_sub(to_mod(residues[i], m), partial, m), mod_inverse(radix, m), m);
+		digits[i] = from_mod(digit, m);
+	}
+}
+
+// given residues (not in montgomery form) of an integer modulo the first num_primes primes
+// returns an approximation of the integer of least absolute value with those residues
+// if low_bits is not NULL, it is set to the exact value mod 2^64, which is the value itself if it fits in a long long
+matrix_entry crt_reconstruct(uint64_t *residues, int num_primes, long long *low_bits) {
+	uint64_t *digits = (uint64_t*) malloc(sizeof(uint64_t) * num_primes);
+	garner_digits(residues, num_primes, digits);
+	// a large leading digit indicates the value is negative, in which case we reconstruct its negation
+	int negative = (digits[num_primes - 1] > prime_table[num_primes - 1] / 2);
+	if (negative) {
+		uint64_t *negated = (uint64_t*) malloc(sizeof(uint64_t) * num_primes);
+		for (int i=0; i<num_primes; i++)
+			negated[i] = (residues[i] == 0) ? 0 : prime_table[i] - residues[i];
+		garner_digits(negated, num_primes, digits);
+		free(negated);
+	}
+	// sum the digits using horner's scheme, both approximately and exactly mod 2^64
+	matrix_entry result = 0;
+	uint64_t result_low = 0;
+	for (int i=num_primes-1; i>=0; i--) {
+		result = result * (matrix_entry) prime_table[i] + (matrix_entry) digits[i];
+		result_low = result_low * prime_table[i] + digits[i];
+	}
+	free(digits);
+	if (negative) {
+		result = -result;
+		result_low = -result_low;
+	}
+	if (low_bits != NULL)
+		*low_bits = (long long) result_low;
+
+	return result;
+}
+
+/* ---------- Testing ---------- */
+// to test, run "make test modular"
+
+#ifdef TEST_MODULAR
+
+/* should output:
+ * mod_mult: 1
+ * mod_inverse: 1
+ * crt_reconstruct: -123456789012345678
+ * crt_reconstruct: 1e+30 */
+void test_modular_functions() {
+	modulus m = modular_prime(0);
+	uint64_t a = to_mod(-2, m), b = to_mod(-(long long) ((m.p + 1) / 2), m);
+	printf("mod_mult: %llu\n", (unsigned long long) from_mod(mod_mult(a, b, m), m));
+	printf("mod_inverse: %llu\n", (unsigned long long) from_mod(mod_mult(a, mod_inverse(a, m), m), m));
+	uint64_t residues[2];
+	long long low_bits;
+	for (int i=0; i<2; i++) {
+		m = modular_prime(i);
+		residues[i] = from_mod(to_mod(-123456789012345678LL, m), m);
+	}
+	crt_reconstruct(residues, 2, &low_bits);
+	printf("crt_reconstruct: %lld\n", low_bits);
+	// 10^30 = 2^30 * 5^30 needs two primes
+	for (int i=0; i<2; i++) {
+		m = modular_prime(i);
+		uint64_t power = to_mod(1, m);
+		for (int j=0; j<30; j++)
+			power = mod_mult(power, to_mod(10, m), m);
+		residues[i] = from_mod(power, m);
+	}
+	printf("crt_reconstruct: %.0e\n", (double) crt_reconstruct(residues, 2, NULL));
+}
+
+int main(int argc, char **argv) {
+	test_modular_functions();
+	exit(0);
+}
+
+#endif
@@ -0,0 +1,71 @@
+// modular.h
+// arithmetic modulo word-size primes, using montgomery multiplication
+
+#ifndef MODULAR_H
+#define MODULAR_H
+
+#include "precision.h"
+#include <stdint.h>
+
+// number of primes in the table used for chinese remaindering
+#define NUM_MODULAR_PRIMES 32
+// every prime in the table is larger than 2^MODULAR_PRIME_BITS
+#define MODULAR_PRIME_BITS 62
+
+// a prime p < 2^63 along with the constants needed for montgomery multiplication
+// residues are stored in montgomery form, i.e. a is represented by a*2^64 mod p
+typedef struct modulus {
+	uint64_t p;
+	uint64_t p_inv;		// -p^-1 mod 2^64
+	uint64_t r2;		// 2^128 mod p
+} modulus;
+
+modulus init_modulus(uint64_t);
+
+modulus modular_prime(int);
+
+int primes_for_bits(double);
+
+uint64_t mod_pow(uint64_t, uint64_t, modulus);
+
+uint64_t mod_inverse(uint64_t, modulus);
+
+matrix_entry crt_reconstruct(uint64_t *, int, long long *);
+
+// montgomery reduction: returns t*2^-64 mod p for t < p*2^64
+static inline uint64_t mod_redc(unsigned __int128 t, modulus m) {
+	uint64_t q = ((uint64_t) t) * m.p_inv;
+	uint64_t result = (uint64_t) ((t + (unsigned __int128) q * m.p) >> 64);
+	return (result >= m.p) ? result - m.p : result;
+}
+
+static inline uint64_t mod_mult(uint64_t a, uint64_t b, modulus m) {
+	return mod_redc((unsigned __int128) a * b, m);
+}
+
+// p < 2^63, so the sum cannot overflow
+static inline uint64_t mod_add(uint64_t a, uint64_t b, modulus m) {
+	uint64_t result = a + b;
+	return (result >= m.p) ? result - m.p : result;
+}
+
+static inline uint64_t mod_sub(uint64_t a, uint64_t b, modulus m) {
+	return (a >= b) ? a - b : a + m.p - b;
+}
+
+static inline uint64_t mod_neg(uint64_t a, modulus m) {
+	return (a == 0) ? 0 : m.p - a;
+}
+
+// converts a signed integer to montgomery form
+static inline uint64_t to_mod(long long a, modulus m) {
+	uint64_t residue = (a >= 0) ? ((uint64_t) a) % m.p : mod_neg(((uint64_t) -(a + 1) + 1) % m.p, m);
+	return mod_mult(residue, m.r2, m);
+}
+
+// converts out of montgomery form, giving the residue in [0, p)
+static inline uint64_t from_mod(uint64_t a, modulus m) {
+	return mod_redc(a, m);
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <assert.h>
+#include <limits.h>
 #include <string.h>
 #define abs(a) ((a >= 0) ? a : -a)	// only use for integers
 
@@ -57,12 +58,41 @@ void free_polynomial(polynomial *p) {
 	free(p);
 }
 
+// lists the nonzero terms of p
+sparse_polynomial *to_sparse_polynomial(polynomial p) {
+	sparse_polynomial *result = (sparse_polynomial*) malloc(sizeof(sparse_polynomial));
+	result->deg = p.deg;
+	result->num_terms = 0;
+	for (int i=0; i<=p.deg; i++) {
+		if (p.coefficients[i] != 0)
+			result->num_terms++;
+	}
+	result->degrees = (int*) malloc(sizeof(int) * result->num_terms);
+	result->coefficients = (int*) malloc(sizeof(int) * result->num_terms);
+	int term = 0;
+	for (int i=0; i<=p.deg; i++) {
+		if (p.coefficients[i] != 0) {
+			result->degrees[term] = p.deg - i;
+			result->coefficients[term] = p.coefficients[i];
+			term++;
+		}
+	}
+	
+	return result;
+}
+
+void free_sparse_polynomial(sparse_polynomial *p) {
+	free(p->degrees);
+	free(p->coefficients);
+	free(p);
+}
+
 // strips leading zeros from a polynomial
 // many functions require that a polynomial have no leading zeros
 void strip_leading_zeros(polynomial *p) {
 	// determine the number of leading zeros
 	int num_leading_zeros = 0;
-	while (p->coefficients[num_leading_zeros] == 0) {
+	while ((num_leading_zeros <= p->deg) && (p->coefficients[num_leading_zeros] == 0)) {
 		num_leading_zeros++;
 	}
 	// check is the polynomial was all zeros
@@ -264,6 +294,43 @@ polynomial *polynomial_mod(polynomial p, polynomial q) {
 	return result;
 }
 
+// given polynomials p and q, returns p / q if q divides p over the integers, and NULL otherwise
+// intermediate values are kept in 128 bits, and a quotient which does not fit in an int is treated as inexact
+polynomial *divide_polynomials(polynomial p, polynomial q) {
+	assert(q.coefficients[0] != 0);	// cannot divide by 0
+	// 0 is divisible by everything
+	if ((p.deg == 0) && (p.coefficients[0] == 0))
+		return int_to_polynomial(0);
+	if (p.deg < q.deg)
+		return NULL;
+	
+	__int128 *remainder = (__int128*) malloc(sizeof(__int128) * (p.deg + 1));
+	for (int i=0; i<=p.deg; i++) {
+		remainder[i] = p.coefficients[i];
+	}
+	polynomial *result = alloc_polynomial(p.deg - q.deg);
+	int exact = 1;
+	for (int i=0; (i<=result->deg) && exact; i++) {
+		__int128 coefficient = remainder[i] / q.coefficients[0];
+		exact = (remainder[i] % q.coefficients[0] == 0) && (coefficient <= INT_MAX) && (coefficient >= INT_MIN);
+		result->coefficients[i] = (int) coefficient;
+		for (int j=0; (j<=q.deg) && exact; j++) {
+			// the remainder stays below 2^95 in absolute value, since p.deg is far less than 2^32
+			remainder[i + j] -= coefficient * q.coefficients[j];
+		}
+	}
+	for (int i=result->deg+1; (i<=p.deg) && exact; i++) {
+		exact = (remainder[i] == 0);
+	}
+	free(remainder);
+	if (!exact) {
+		free_polynomial(result);
+		return NULL;
+	}
+	
+	return result;
+}
+
 /* ---------- Input / Output ---------- */
 
 // reads a polynomial from stdin
@@ -364,6 +431,7 @@ void print_polynomial(polynomial p) {
 
 /* should output:
  * print_polynomial: x^2 - 2
+ * to_sparse_polynomial: 2 terms, x^3 and x^0
  * stript_leading_zeros: x^1 + 1
  * eval_polynomial: 0
  * add_polynomials: x^3 + x^2 - 3
@@ -378,6 +446,9 @@ void print_polynomial(polynomial p) {
  * linear_change_of_variables: x^2 - 2x^1 - 1
  * differentiate: 2x^1
  * polynomial_mod: 2x^1 - 1	
+ * divide_polynomials: x^3 - 1
+ * divide_polynomials: 1
+ * divide_polynomials: 1
  * read_polynomial can be checked by hand */
 void test_polynomial_functions() {
 	polynomial *p = alloc_polynomial(2);
@@ -391,6 +462,9 @@ void test_polynomial_functions() {
 	q->coefficients[3] = -1;
 	printf("print_polynomial: ");
 	print_polynomial(*p);
+	sparse_polynomial *q_sparse = to_sparse_polynomial(*q);
+	printf("to_sparse_polynomial: %d terms, x^%d and x^%d\n", q_sparse->num_terms, q_sparse->degrees[0], q_sparse->degrees[1]);
+	free_sparse_polynomial(q_sparse);
 	polynomial *malformed = alloc_polynomial(2);
 	malformed->coefficients[0] = 0;	// leading coefficient is 0
 	malformed->coefficients[1] = 1;
@@ -423,6 +497,16 @@ void test_polynomial_functions() {
 	print_polynomial(*differentiate(*p));
 	printf("polynomial_mod: ");
 	print_polynomial(*polynomial_mod(*q, *p));
+	printf("divide_polynomials: ");
+	print_polynomial(*divide_polynomials(*mult_polynomials(*p, *q), *p));
+	printf("divide_polynomials: %d\n", divide_polynomials(*q, *p) == NULL);
+	// x^3 / (x + 100000) is inexact, and its quotient does not fit in an int
+	polynomial *cube = calloc_polynomial(3);
+	cube->coefficients[0] = 1;
+	polynomial *shift = alloc_polynomial(1);
+	shift->coefficients[0] = 1;
+	shift->coefficients[1] = 100000;
+	printf("divide_polynomials: %d\n", divide_polynomials(*cube, *shift) == NULL);
 	printf("read_polynomial: ");
 	print_polynomial(*read_polynomial());
 }
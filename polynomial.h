@@ -12,6 +12,14 @@ typedef struct polynomial {
 						// coefficients[0] MUST be nonzero
 } polynomial;
 
+// a polynomial stored as its nonzero terms, for polynomials with few terms such as x^n - a
+typedef struct sparse_polynomial {
+	int deg;
+	int num_terms;
+	int *degrees;		// from highest to lowest
+	int *coefficients;	// coefficients[i] is the coefficient of x^degrees[i], and is nonzero
+} sparse_polynomial;
+
 polynomial *int_to_polynomial(int);
 
 polynomial *alloc_polynomial(int);
@@ -22,6 +30,10 @@ polynomial *copy_polynomial(polynomial);
 
 void free_polynomial(polynomial*);
 
+sparse_polynomial *to_sparse_polynomial(polynomial);
+
+void free_sparse_polynomial(sparse_polynomial*);
+
 void strip_leading_zeros(polynomial*);
 
 root_type eval_polynomial(polynomial, root_type);
@@ -52,6 +64,8 @@ polynomial *differentiate(polynomial);
 
 polynomial *polynomial_mod(polynomial, polynomial);
 
+polynomial *divide_polynomials(polynomial, polynomial);
+
 polynomial *read_polynomial();
 
 void print_polynomial(polynomial);
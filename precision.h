@@ -8,6 +8,7 @@
 #define EVAL_ERR 1e-20
 #define MIN_ROOT_ERR 1e-12
 #define MATRIX_IND_ERR 1e-10
+#define MATRIX_ENTRY_EPS 1.9259299443872358530559779425849273e-34Q	// machine epsilon of matrix_entry
 
 // the precision of some functions can be changed by changing the following typedefs:
 typedef __float128 matrix_entry;
@@ -5,126 +5,354 @@
 #include "resultant.h"
 #include "matrices.h"
 #include "interpolate.h"
+#include "modular.h"
+#include "threads.h"
+#include "composed.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include <math.h>
 
-// returns the sylvester matrix w.r.t. y of p(y) and q(x - y) evaluated at x = x_val
-static matrix *sylvester_matrix_sum(polynomial p, polynomial q, int x_val) {
-	assert((p.deg > 0) && (q.deg > 0));	// the sylvester matrix is not defined for constant polynomials
-	// get the coefficients of q(x_val - y)
-	polynomial *q_shifted = linear_change_of_variables(q, -1, x_val);
-	// calculate sylvester matrix
-	matrix *result = alloc_matrix(p.deg + q_shifted->deg, p.deg + q_shifted->deg);
-	for (int i=0; i<q_shifted->deg; i++) {
-		for (int j=0; j<i; j++) {
-			result->entries[i][j] = 0;
+/* ---------- Scratch Space ---------- */
+
+// buffers for evaluating resultants of p and q at single points, one per worker
+// the sylvester matrix is only allocated if some point needs the determinant fallback
+typedef struct resultant_scratch {
+	uint64_t *residues;
+	uint64_t *a, *b;
+	matrix *sylv_matrix;
+} resultant_scratch;
+
+static resultant_scratch *alloc_scratch(polynomial p, polynomial q, int num_scratch) {
+	resultant_scratch *result = (resultant_scratch*) malloc(sizeof(resultant_scratch) * num_scratch);
+	for (int i=0; i<num_scratch; i++) {
+		result[i].residues = (uint64_t*) malloc(sizeof(uint64_t) * NUM_MODULAR_PRIMES);
+		result[i].a = (uint64_t*) malloc(sizeof(uint64_t) * (p.deg + 1));
+		result[i].b = (uint64_t*) malloc(sizeof(uint64_t) * (q.deg + 1));
+		result[i].sylv_matrix = NULL;
+	}
+
+	return result;
+}
+
+static void free_scratch(resultant_scratch *scratch, int num_scratch) {
+	for (int i=0; i<num_scratch; i++) {
+		free(scratch[i].residues);
+		free(scratch[i].a);
+		free(scratch[i].b);
+		if (scratch[i].sylv_matrix != NULL)
+			free_matrix(scratch[i].sylv_matrix);
+	}
+	free(scratch);
+}
+
+// returns the scratch sylvester matrix, which is large enough for any point
+static matrix *scratch_sylvester(polynomial p, polynomial q, resultant_scratch *scratch) {
+	if (scratch->sylv_matrix == NULL)
+		scratch->sylv_matrix = alloc_matrix(p.deg + q.deg, p.deg + q.deg);
+
+	return scratch->sylv_matrix;
+}
+
+/* ---------- Structured Resultants ---------- */
+
+// multiplies x by (-1)^n
+static uint64_t mod_sign(uint64_t x, long n, modulus m) {
+	return (n % 2 == 0) ? x : mod_neg(x, m);
+}
+
+// computes the resultant of a and b mod m using the euclidean algorithm
+// a and b are coefficient arrays in montgomery form, from highest to lowest degree, of formal degrees deg_a and deg_b
+// leading coefficients may be zero, in which case the result is the sylvester determinant for the formal degrees
+// the contents of a and b are overwritten
+// runtime: O(deg_a * deg_b)
+static uint64_t euclidean_resultant_mod(uint64_t *a, int deg_a, uint64_t *b, int deg_b, modulus m) {
+	uint64_t result = to_mod(1, m);
+	while (1) {
+		// remove zero leading coefficients by expanding the sylvester determinant along its first column
+		if ((deg_a > 0) && (a[0] == 0)) {
+			if ((deg_b > 0) && (b[0] == 0))
+				return 0;	// the first column is zero
+			result = mod_sign(mod_mult(result, b[0], m), deg_b, m);
+			a++;
+			deg_a--;
+			continue;
 		}
-		for (int j=i; j<=i+p.deg; j++) {
-			result->entries[i][j] = p.coefficients[j - i];
+		if ((deg_b > 0) && (b[0] == 0)) {
+			result = mod_mult(result, a[0], m);
+			b++;
+			deg_b--;
+			continue;
 		}
-		for (int j=i+p.deg+1; j<p.deg+q_shifted->deg; j++) {
-			result->entries[i][j] = 0;
+		// res(a, c) = c^deg_a for a constant c, and similarly res(c, b) = c^deg_b
+		if (deg_b == 0)
+			return mod_mult(result, mod_pow(b[0], deg_a, m), m);
+		if (deg_a == 0)
+			return mod_mult(result, mod_pow(a[0], deg_b, m), m);
+		// res(a, b) = (-1)^(deg_a*deg_b) res(b, a)
+		if (deg_a < deg_b) {
+			uint64_t *temp_ptr = a;
+			a = b;
+			b = temp_ptr;
+			int temp_deg = deg_a;
+			deg_a = deg_b;
+			deg_b = temp_deg;
+			result = mod_sign(result, (long) deg_a * deg_b, m);
 		}
-	}
-	for (int i=q_shifted->deg; i<p.deg+q_shifted->deg; i++) {
-		for (int j=0; j<i-q_shifted->deg; j++) {
-			result->entries[i][j] = 0;
+		// replace a by its remainder mod b, which is left in a[deg_a-deg_b+1],...,a[deg_a]
+		uint64_t lc_inv = mod_inverse(b[0], m);
+		for (int i=0; i<=deg_a-deg_b; i++) {
+			uint64_t quotient_coeff = mod_mult(a[i], lc_inv, m);
+			if (quotient_coeff == 0)
+				continue;
+			for (int j=1; j<=deg_b; j++)
+				a[i + j] = mod_sub(a[i + j], mod_mult(quotient_coeff, b[j], m), m);
 		}
-		for (int j=i-q_shifted->deg; j<=i; j++) {
-			result->entries[i][j] = q_shifted->coefficients[j - i + q_shifted->deg];
-		}
-		for (int j=i+1; j<p.deg+q_shifted->deg; j++) {
-			result->entries[i][j] = 0;
+		uint64_t *remainder = a + deg_a - deg_b + 1;
+		int deg_remainder = deg_b - 1;
+		while ((deg_remainder >= 0) && (remainder[0] == 0)) {
+			remainder++;
+			deg_remainder--;
 		}
+		if (deg_remainder < 0)
+			return 0;	// a and b have a common factor
+		// res(a, b) = (-1)^(deg_a*deg_b) lc(b)^(deg_a-deg_remainder) res(b, a mod b)
+		result = mod_sign(result, (long) deg_a * deg_b, m);
+		result = mod_mult(result, mod_pow(b[0], deg_a - deg_remainder, m), m);
+		a = b;
+		deg_a = deg_b;
+		b = remainder;
+		deg_b = deg_remainder;
 	}
-	// free intermediates
-	free_polynomial(q_shifted);
-	
-	return result;
 }
 
-static matrix_entry scalar_resultant_sum(polynomial p, polynomial q, matrix_entry x_val) {
-	matrix *sylv_matrix = sylvester_matrix_sum(p, q, x_val);
-	matrix_entry result = det(*sylv_matrix);
-	free_matrix(sylv_matrix);
-	
-	return result;
+// returns log2 of the 1-norm of the coefficients of p
+static double log2_norm(polynomial p) {
+	double norm = 0;
+	for (int i=0; i<=p.deg; i++)
+		norm += fabs((double) p.coefficients[i]);
+
+	return log2(norm);
 }
 
-// computes a polynomial with zeros at the sums of the zeros of p and q
-polynomial *resultant_sum(polynomial p, polynomial q) {
-	// evaluate the resultant at 0,...,p.deg*q.deg
-	vector vals = (vector) malloc(sizeof(matrix_entry) * (p.deg * q.deg + 1));
-	for (int i=0; i<=p.deg*q.deg; i++) {
-		vals[i] = scalar_resultant_sum(p, q, i);
+// evaluates res_y(p(y), b(y)) exactly, where b is the polynomial of formal degree deg_b produced by shifted_coeffs
+// shifted_coeffs fills in the coefficients of b mod m, in montgomery form and from highest to lowest degree
+// b_bits is log2 of a bound on the 1-norm of the coefficients of b
+// hadamard's inequality for the sylvester matrix bounds the resultant by 2^(deg_b*log2|p| + p.deg*b_bits)
+static matrix_entry structured_resultant(polynomial p, polynomial q, int x_val, int deg_b, double b_bits,
+		void (*shifted_coeffs)(polynomial, int, modulus, uint64_t *), resultant_scratch *scratch) {
+	int num_primes = primes_for_bits(deg_b * log2_norm(p) + p.deg * b_bits);
+	for (int k=0; k<num_primes; k++) {
+		modulus m = modular_prime(k);
+		for (int i=0; i<=p.deg; i++)
+			scratch->a[i] = to_mod(p.coefficients[i], m);
+		shifted_coeffs(q, x_val, m, scratch->b);
+		scratch->residues[k] = from_mod(euclidean_resultant_mod(scratch->a, p.deg, scratch->b, deg_b, m), m);
 	}
-	// interpolate to recover the desired polynomial
-	polynomial *result = interpolate(vals, p.deg * q.deg);
-	free(vals);
-	
-	return result;
+
+	return crt_reconstruct(scratch->residues, num_primes, NULL);
 }
 
-// returns the sylvester matrix w.r.t. y of p(y) and y^n*q(x/y) evaluated at x = x_val
-static matrix *sylvester_matrix_product(polynomial p, polynomial q, int x_val) {
-	assert((p.deg > 0) && (q.deg > 0));	// the sylvester matrix is not defined for constant polynomials
-	// get the coefficients of y^n*q(x_val/y)
-	polynomial *q_fixed_x = linear_change_of_variables(q, x_val, 0);
-	polynomial *q_reversed = reverse_polynomial(*q_fixed_x);
-	free_polynomial(q_fixed_x);
-	// calculate sylvester matrix
-	matrix *result = alloc_matrix(p.deg + q_reversed->deg, p.deg + q_reversed->deg);
-	for (int i=0; i<q_reversed->deg; i++) {
+// returns 1 if a resultant bounded by 2^bits can be recovered by structured_resultant
+static int structured_resultant_fits(double bits) {
+	return bits + 2.0 <= NUM_MODULAR_PRIMES * MODULAR_PRIME_BITS;
+}
+
+// fills in the coefficients of q(x_val - y) mod m, as a polynomial in y
+// uses a taylor shift, so the integer coefficients (which may overflow) are never formed
+// runtime: O(q.deg^2)
+static void sum_shifted_coeffs(polynomial q, int x_val, modulus m, uint64_t *result) {
+	uint64_t shift = to_mod(x_val, m);
+	for (int i=0; i<=q.deg; i++)
+		result[i] = to_mod(q.coefficients[i], m);
+	// compute q(x_val + t) by repeated synthetic division
+	for (int i=0; i<q.deg; i++) {
+		for (int j=1; j<=q.deg-i; j++)
+			result[j] = mod_add(result[j], mod_mult(shift, result[j - 1], m), m);
+	}
+	// substitute t = -y
+	for (int i=0; i<=q.deg; i++)
+		result[i] = mod_sign(result[i], q.deg - i, m);
+}
+
+// fills in the coefficients of y^q.deg * q(x_val / y) mod m, as a polynomial in y
+// runtime: O(q.deg)
+static void product_shifted_coeffs(polynomial q, int x_val, modulus m, uint64_t *result) {
+	uint64_t x_power = to_mod(1, m), x = to_mod(x_val, m);
+	// the coefficient of y^(q.deg-k) is x_val^k times the coefficient of z^k in q(z)
+	for (int k=0; k<=q.deg; k++) {
+		result[k] = mod_mult(to_mod(q.coefficients[q.deg - k], m), x_power, m);
+		x_power = mod_mult(x_power, x, m);
+	}
+}
+
+// returns log2 of a bound on the 1-norm of the coefficients of q(x_val - y)
+static double sum_shifted_bits(polynomial q, int x_val) {
+	double norm = 0;
+	for (int i=0; i<=q.deg; i++)
+		norm += fabs((double) q.coefficients[i]) * pow(1.0 + abs(x_val), q.deg - i);
+
+	return log2(norm);
+}
+
+// returns log2 of a bound on the 1-norm of the coefficients of y^q.deg * q(x_val / y)
+static double product_shifted_bits(polynomial q, int x_val) {
+	double norm = 0;
+	for (int i=0; i<=q.deg; i++)
+		norm += fabs((double) q.coefficients[i]) * pow(abs(x_val), q.deg - i);
+
+	return log2(norm);
+}
+
+/* ---------- Sylvester Matrices ---------- */
+
+// fills in the sylvester matrix of p and b, shrinking result to size p.deg + b.deg
+// result must have been allocated with at least that many rows and columns
+static void fill_sylvester(polynomial p, polynomial b, matrix *result) {
+	assert((p.deg > 0) && (b.deg > 0));	// the sylvester matrix is not defined for constant polynomials
+	result->m = result->n = p.deg + b.deg;
+	for (int i=0; i<b.deg; i++) {
 		for (int j=0; j<i; j++) {
 			result->entries[i][j] = 0;
 		}
 		for (int j=i; j<=i+p.deg; j++) {
 			result->entries[i][j] = p.coefficients[j - i];
 		}
-		for (int j=i+p.deg+1; j<p.deg+q_reversed->deg; j++) {
+		for (int j=i+p.deg+1; j<p.deg+b.deg; j++) {
 			result->entries[i][j] = 0;
 		}
 	}
-	for (int i=q_reversed->deg; i<p.deg+q_reversed->deg; i++) {
-		for (int j=0; j<i-q_reversed->deg; j++) {
+	for (int i=b.deg; i<p.deg+b.deg; i++) {
+		for (int j=0; j<i-b.deg; j++) {
 			result->entries[i][j] = 0;
 		}
-		for (int j=i-q_reversed->deg; j<=i; j++) {
-			result->entries[i][j] = q_reversed->coefficients[j - i + q_reversed->deg];
+		for (int j=i-b.deg; j<=i; j++) {
+			result->entries[i][j] = b.coefficients[j - i + b.deg];
 		}
-		for (int j=i+1; j<p.deg+q_reversed->deg; j++) {
+		for (int j=i+1; j<p.deg+b.deg; j++) {
 			result->entries[i][j] = 0;
 		}
 	}
-	// free intermediates
+}
+
+// fills in the sylvester matrix w.r.t. y of p(y) and q(x - y) evaluated at x = x_val
+static void sylvester_matrix_sum(polynomial p, polynomial q, int x_val, matrix *result) {
+	// get the coefficients of q(x_val - y)
+	polynomial *q_shifted = linear_change_of_variables(q, -1, x_val);
+	fill_sylvester(p, *q_shifted, result);
+	free_polynomial(q_shifted);
+}
+
+// evaluates res_y(p(y), q(x_val - y))
+// uses the structured evaluator unless the resultant is too large, in which case the sylvester determinant is used
+static matrix_entry scalar_resultant_sum(polynomial p, polynomial q, int x_val, resultant_scratch *scratch) {
+	double b_bits = sum_shifted_bits(q, x_val);
+	if (structured_resultant_fits(q.deg * log2_norm(p) + p.deg * b_bits))
+		return structured_resultant(p, q, x_val, q.deg, b_bits, sum_shifted_coeffs, scratch);
+	matrix *sylv_matrix = scratch_sylvester(p, q, scratch);
+	sylvester_matrix_sum(p, q, x_val, sylv_matrix);
+
+	return integer_det(*sylv_matrix);
+}
+
+// fills in the sylvester matrix w.r.t. y of p(y) and y^n*q(x/y) evaluated at x = x_val
+static void sylvester_matrix_product(polynomial p, polynomial q, int x_val, matrix *result) {
+	// get the coefficients of y^n*q(x_val/y)
+	polynomial *q_fixed_x = linear_change_of_variables(q, x_val, 0);
+	polynomial *q_reversed = reverse_polynomial(*q_fixed_x);
+	free_polynomial(q_fixed_x);
+	fill_sylvester(p, *q_reversed, result);
 	free_polynomial(q_reversed);
-	
-	return result;
 }
 
-static matrix_entry scalar_resultant_product(polynomial p, polynomial q, matrix_entry x_val) {
-	matrix *sylv_matrix = sylvester_matrix_product(p, q, x_val);
-	matrix_entry result = det(*sylv_matrix);
-	free_matrix(sylv_matrix);
-	
+// evaluates res_y(p(y), y^q.deg * q(x_val / y)) as a sylvester determinant
+// at 0 the second polynomial is q(0)*y^q.deg, whose leading zeros sylvester_matrix_product would strip,
+// so the determinant for the formal degrees is given in closed form as (-1)^(p.deg*q.deg) p(0)^q.deg q(0)^p.deg
+static matrix_entry sylvester_resultant_product(polynomial p, polynomial q, int x_val, resultant_scratch *scratch) {
+	if (x_val == 0) {
+		matrix_entry result = ((long) p.deg * q.deg % 2 == 0) ? 1 : -1;
+		for (int i=0; i<q.deg; i++)
+			result *= p.coefficients[p.deg];
+		for (int i=0; i<p.deg; i++)
+			result *= q.coefficients[q.deg];
+		return result;
+	}
+	matrix *sylv_matrix = scratch_sylvester(p, q, scratch);
+	sylvester_matrix_product(p, q, x_val, sylv_matrix);
+
+	return integer_det(*sylv_matrix);
+}
+
+// evaluates res_y(p(y), y^q.deg * q(x_val / y))
+// uses the structured evaluator unless the resultant is too large, in which case the sylvester determinant is used
+static matrix_entry scalar_resultant_product(polynomial p, polynomial q, int x_val, resultant_scratch *scratch) {
+	double b_bits = product_shifted_bits(q, x_val);
+	if (structured_resultant_fits(q.deg * log2_norm(p) + p.deg * b_bits))
+		return structured_resultant(p, q, x_val, q.deg, b_bits, product_shifted_coeffs, scratch);
+
+	return sylvester_resultant_product(p, q, x_val, scratch);
+}
+
+/* ---------- Parallel Evaluation ---------- */
+
+// the sample points of a resultant, shared by the tasks evaluating them
+typedef struct resultant_job {
+	polynomial p, q;
+	matrix_entry (*scalar_resultant)(polynomial, polynomial, int, resultant_scratch *);
+	resultant_scratch *scratch;	// indexed by worker
+	vector vals;
+} resultant_job;
+
+// evaluates the resultant at x = task
+static void resultant_task(int task, int worker, void *arg) {
+	resultant_job *job = (resultant_job*) arg;
+	job->vals[task] = job->scalar_resultant(job->p, job->q, task, &job->scratch[worker]);
+}
+
+// evaluates the resultant at 0,...,p.deg*q.deg, dividing the points between the worker threads
+// then interpolates to recover the resultant as a polynomial in x
+static polynomial *interpolate_resultant(polynomial p, polynomial q,
+		matrix_entry (*scalar_resultant)(polynomial, polynomial, int, resultant_scratch *)) {
+	int num_points = p.deg * q.deg + 1;
+	int num_scratch = num_workers();
+	resultant_job job;
+	job.p = p;
+	job.q = q;
+	job.scalar_resultant = scalar_resultant;
+	job.scratch = alloc_scratch(p, q, num_scratch);
+	job.vals = (vector) malloc(sizeof(matrix_entry) * num_points);
+	parallel_for(num_points, resultant_task, &job);
+	free_scratch(job.scratch, num_scratch);
+	polynomial *result = interpolate(job.vals, p.deg * q.deg);
+	free(job.vals);
+
 	return result;
 }
 
-// computes a polynomial with zeros at the sums of the products of p and q
+// computes a polynomial with zeros at the sums of the zeros of p and q
+// uses the power sum kernel, falling back to evaluating and interpolating the resultant if the kernel cannot evaluate it
+// returns NULL if the coefficients of the resultant do not fit in an int, which the interpolation would reject as well
+// runtime: O((p.deg*q.deg)^2) per prime, or O((p.deg*q.deg)*(p.deg+q.deg)^2) resultant evaluations for the fallback
+polynomial *resultant_sum(polynomial p, polynomial q) {
+	composed_status status;
+	polynomial *result = composed_sum(p, q, &status);
+	if (status != COMPOSED_EVAL_FAILED)
+		return result;
+
+	return interpolate_resultant(p, q, scalar_resultant_sum);
+}
+
+// computes a polynomial with zeros at the products of the zeros of p and q
+// uses the power sum kernel, falling back to evaluating and interpolating the resultant if the kernel cannot evaluate it
+// returns NULL if the coefficients of the resultant do not fit in an int, which the interpolation would reject as well
+// runtime: O((p.deg*q.deg)^2) per prime, or O((p.deg*q.deg)*(p.deg+q.deg)^2) resultant evaluations for the fallback
 polynomial *resultant_product(polynomial p, polynomial q) {
-	// evaluate the resultant at 0,...,p.deg*q.deg
-	vector vals = (vector) malloc(sizeof(matrix_entry) * (p.deg * q.deg + 1));
-	// determinant algorithm doesn't always work for determinant 0, so this is kind of a hack
-	vals[0] = 0;
-	for (int i=1; i<=p.deg*q.deg; i++) {
-		vals[i] = scalar_resultant_product(p, q, i);
-	}
-	// interpolate to recover the desired polynomial
-	polynomial *result = interpolate(vals, p.deg * q.deg);
-	free(vals);
-	
-	return result;
+	composed_status status;
+	polynomial *result = composed_product(p, q, &status);
+	if (status != COMPOSED_EVAL_FAILED)
+		return result;
+
+	return interpolate_resultant(p, q, scalar_resultant_product);
 }
 
 /* ---------- Testing ---------- */
@@ -132,10 +360,25 @@ polynomial *resultant_product(polynomial p, polynomial q) {
 
 #ifdef TEST_RESULTANT
 
+static int polynomials_equal(polynomial a, polynomial b) {
+	if (a.deg != b.deg)
+		return 0;
+	for (int i=0; i<=a.deg; i++) {
+		if (a.coefficients[i] != b.coefficients[i])
+			return 0;
+	}
+
+	return 1;
+}
+
 /* should output:
  * resultant_sum: -8x^6 - 16x^5 + 112x^4 + 256x^3 - 168x^2 - 496x^1 - 192
  * x^10 - 10x^8 + 38x^6 + 2x^5 - 100x^4 + 40x^3 + 121x^2 + 38x^1 - 17
- * resultant_product: 8x^6 + 32x^5 - 160x^4 + 128x^3 */
+ * resultant_product: -8x^6 - 32x^5 + 160x^4 - 128x^3
+ * structured_resultant: 1
+ * parallel resultant: 1
+ * composed: 1
+ * overflow: 1 */
 void test_resultant_functions() {
 	polynomial *p = alloc_polynomial(3);
 	p->coefficients[0] = -1;
@@ -158,6 +401,54 @@ void test_resultant_functions() {
 	print_polynomial(*resultant_sum(*f, *g));
 	printf("resultant_product: ");
 	print_polynomial(*resultant_product(*p, *q));
+	// compare the structured evaluator with the sylvester determinants
+	int agree = 1;
+	resultant_scratch *scratch = alloc_scratch(*f, *g, 1);
+	matrix *sylv_matrix = alloc_matrix(f->deg + g->deg, f->deg + g->deg);
+	for (int x_val=1; x_val<=10; x_val++) {
+		sylvester_matrix_sum(*f, *g, x_val, sylv_matrix);
+		agree &= (scalar_resultant_sum(*f, *g, x_val, scratch) == integer_det(*sylv_matrix));
+		sylvester_matrix_product(*f, *g, x_val, sylv_matrix);
+		agree &= (scalar_resultant_product(*f, *g, x_val, scratch) == integer_det(*sylv_matrix));
+	}
+	// at 0 the determinant fallback should match the structured evaluator and the constant term of the composed product
+	polynomial *composed = composed_product(*f, *g, NULL);
+	agree &= (sylvester_resultant_product(*f, *g, 0, scratch) == scalar_resultant_product(*f, *g, 0, scratch));
+	agree &= (sylvester_resultant_product(*f, *g, 0, scratch) == composed->coefficients[composed->deg]);
+	free_polynomial(composed);
+	free_matrix(sylv_matrix);
+	free_scratch(scratch, 1);
+	printf("structured_resultant: %d\n", agree);
+	// the points should give the same result however they are divided between threads
+	set_num_workers(1);
+	polynomial *serial = interpolate_resultant(*p, *q, scalar_resultant_product);
+	set_num_workers(4);
+	polynomial *parallel = interpolate_resultant(*p, *q, scalar_resultant_product);
+	printf("parallel resultant: %d\n", polynomials_equal(*serial, *parallel));
+	free_polynomial(serial);
+	free_polynomial(parallel);
+	// the power sum kernels should agree with the interpolated resultants
+	composed = composed_sum(*f, *g, NULL);
+	polynomial *interpolated = interpolate_resultant(*f, *g, scalar_resultant_sum);
+	agree = polynomials_equal(*composed, *interpolated);
+	free_polynomial(composed);
+	free_polynomial(interpolated);
+	composed = composed_product(*p, *q, NULL);
+	interpolated = interpolate_resultant(*p, *q, scalar_resultant_product);
+	agree &= polynomials_equal(*composed, *interpolated);
+	free_polynomial(composed);
+	free_polynomial(interpolated);
+	printf("composed: %d\n", agree);
+	// the composed product of x^4 + x - 1000 with itself has constant term about 10^12,
+	// so NULL is returned without sampling the resultant and filling the interpolation cache
+	polynomial *h = calloc_polynomial(4);
+	h->coefficients[0] = 1;
+	h->coefficients[3] = 1;
+	h->coefficients[4] = -1000;
+	interpolation_cache_stats before = get_interpolation_cache_stats();
+	polynomial *overflowed = resultant_product(*h, *h);
+	interpolation_cache_stats after = get_interpolation_cache_stats();
+	printf("overflow: %d\n", (overflowed == NULL) && (after.hits + after.misses == before.hits + before.misses));
 }
 
 int main(int argc, char **argv) {
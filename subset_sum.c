@@ -2,166 +2,747 @@
 // solves the subset sum problem in O(2^(n/2)) time and space
 
 #include "subset_sum.h"
+#include "threads.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <assert.h>
 #include <float.h>
 #include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 
-// merges two sorted lists of size n in O(n) time
-// breaks ties towards first list
-// frees its inputs
-// NOTE: list1 and list2 must have memory for an additional entry
-// the returned list has memory for an additional memory
-static root_type *merge_lists(int size, root_type *list1, root_type *list2) {
-	root_type *result = (root_type*) malloc(sizeof(root_type) * (2 * size + 1));
-	assert(result != NULL);
+#define min(a, b) ((a < b) ? a : b)
+#define SORT_BLOCK 16384	// number of sums each task builds, counts or scatters
+#define SCAN_BLOCK 4096		// number of sums of the first half each task scans
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define EXTERNAL_RUN_SUMS (1 << 22)	// number of sums the out-of-core builder sorts in memory at a time
+#define MAX_EXTERNAL_SIZE 60		// so that the 2^30 sums of each half can be indexed by an int
+
+/* ---------- Sorted Sums ---------- */
+
+// the sums being built and sorted, shared by the tasks of get_sorted_sums
+typedef struct sums_job {
+	root_type *vals;
+	int size, num_sums;
+	int level;				// the item being added to the sums built so far
+	partial_sum *src, *dst;	// the sums are scattered from src to dst by each pass of the radix sort
+	int shift;				// the digit sorted by the current pass
+	int descending;			// 1 if the sums are sorted from largest to smallest
+	int *offsets;			// RADIX_BUCKETS counts, and then starting positions, for each block
+} sums_job;
+
+// maps a sum to an unsigned integer with the same order, by flipping all bits of negative values and the sign bit of others
+static uint64_t sort_key(root_type x) {
+	uint64_t bits;
+	memcpy(&bits, &x, sizeof(bits));
+	return (bits >> 63) ? ~bits : (bits | ((uint64_t) 1 << 63));
+}
+
+// returns the digit of the sort key of x sorted by the current pass
+static int sort_digit(sums_job *job, root_type x) {
+	uint64_t key = job->descending ? ~sort_key(x) : sort_key(x);
+	return (key >> job->shift) & (RADIX_BUCKETS - 1);
+}
+
+// builds the taskth block of the sums which include the item job->level, by adding it to the sums of the lower items
+// so each sum adds up its items in increasing order, and rounds the same way however the work is divided
+static void extend_task(int task, int worker, void *arg) {
+	sums_job *job = (sums_job*) arg;
+	int num_lower = 1 << job->level;
+	int end = min((task + 1) * SORT_BLOCK, num_lower);
+	root_type val = job->vals[job->level];
+	uint64_t bit = (uint64_t) 1 << job->level;
+	for (int j=task*SORT_BLOCK; j<end; j++) {
+		job->src[num_lower + j].sum = job->src[j].sum + val;
+		job->src[num_lower + j].mask = job->src[j].mask | bit;
+	}
+}
+
+// counts the digits of the taskth block of sums
+static void count_task(int task, int worker, void *arg) {
+	sums_job *job = (sums_job*) arg;
+	int *counts = job->offsets + task * RADIX_BUCKETS;
+	memset(counts, 0, sizeof(int) * RADIX_BUCKETS);
+	int end = min((task + 1) * SORT_BLOCK, job->num_sums);
+	for (int i=task*SORT_BLOCK; i<end; i++)
+		counts[sort_digit(job, job->src[i].sum)]++;
+}
+
+// moves the taskth block of sums to their positions after sorting by the current digit
+static void scatter_task(int task, int worker, void *arg) {
+	sums_job *job = (sums_job*) arg;
+	int *positions = job->offsets + task * RADIX_BUCKETS;
+	int end = min((task + 1) * SORT_BLOCK, job->num_sums);
+	for (int i=task*SORT_BLOCK; i<end; i++)
+		job->dst[positions[sort_digit(job, job->src[i].sum)]++] = job->src[i];
+}
+
+// sorts the sums in job->src by a least significant digit radix sort on their bits, with the blocks of each pass divided between threads
+// the sorted sums end up in job->src
+static void radix_sort(sums_job *job) {
+	int num_blocks = (job->num_sums + SORT_BLOCK - 1) / SORT_BLOCK;
+	job->offsets = (int*) malloc(sizeof(int) * num_blocks * RADIX_BUCKETS);
+	for (job->shift=0; job->shift<64; job->shift+=RADIX_BITS) {
+		parallel_for(num_blocks, count_task, job);
+		// the blocks of each bucket are placed in order, so the sort is stable
+		int position = 0, skip = 0;
+		for (int digit=0; digit<RADIX_BUCKETS; digit++) {
+			int digit_start = position;
+			for (int block=0; block<num_blocks; block++) {
+				int count = job->offsets[block * RADIX_BUCKETS + digit];
+				job->offsets[block * RADIX_BUCKETS + digit] = position;
+				position += count;
+			}
+			// a digit shared by every sum leaves the order unchanged
+			if (position - digit_start == job->num_sums)
+				skip = 1;
+		}
+		if (skip)
+			continue;
+		parallel_for(num_blocks, scatter_task, job);
+		partial_sum *temp = job->src;
+		job->src = job->dst;
+		job->dst = temp;
+	}
+	free(job->offsets);
+}
+
+// used to get list of sorted sums of the subsets of vals, along with the subsets
+// the sums are built into one buffer, doubling the number of sums with each item, and then radix sorted
+// they are sorted from largest to smallest if descending is 1
+static partial_sum *get_sorted_sums(int size, root_type *vals, int descending) {
+	assert(size < 31);
+	sums_job job;
+	job.descending = descending;
+	job.vals = vals;
+	job.size = size;
+	job.num_sums = 1 << size;
+	job.src = (partial_sum*) malloc(sizeof(partial_sum) * job.num_sums);
+	job.dst = (partial_sum*) malloc(sizeof(partial_sum) * job.num_sums);
+	assert((job.src != NULL) && (job.dst != NULL));
+	job.src[0].sum = 0;
+	job.src[0].mask = 0;
+	for (job.level=0; job.level<size; job.level++)
+		parallel_for(((1 << job.level) + SORT_BLOCK - 1) / SORT_BLOCK, extend_task, &job);
+	radix_sort(&job);
+	
+	free(job.dst);
+	return job.src;
+}
+
+// sorts sums in place by their sums, keeping the order of equal sums
+void sort_sums(partial_sum *sums, int num_sums) {
+	sums_job job;
+	job.descending = 0;
+	job.num_sums = num_sums;
+	job.src = sums;
+	job.dst = (partial_sum*) malloc(sizeof(partial_sum) * num_sums);
+	assert(job.dst != NULL);
+	radix_sort(&job);
+	if (job.src != sums) {
+		memcpy(sums, job.src, sizeof(partial_sum) * num_sums);
+		job.dst = job.src;
+	}
+	free(job.dst);
+}
+
+/* ---------- Out-of-Core Sorted Sums ---------- */
+
+// number of sums in each sorted run of the out-of-core builder, which is only changed by tests
+static int run_sums = EXTERNAL_RUN_SUMS;
+
+// a run being merged by get_sorted_sums_external, and the position of its next sum
+typedef struct run_head {
+	root_type sum;
+	int run, pos;
+} run_head;
+
+// maps a new temporary file with room for num_sums sums, which is removed once it is unmapped
+// the space is reserved up front, so running out of disk is reported here rather than by SIGBUS on a later write
+// returns NULL on failure
+static partial_sum *map_temp_file(size_t num_sums) {
+	const char *directory = getenv("TMPDIR");
+	if (directory == NULL)
+		directory = "/tmp";
+	char *path = (char*) malloc(strlen(directory) + 20);
+	sprintf(path, "%s/subset_sum_XXXXXX", directory);
+	int fd = mkstemp(path);
+	unlink(path);
+	free(path);
+	if (fd < 0)
+		return NULL;
+	void *result = MAP_FAILED;
+	if (posix_fallocate(fd, 0, sizeof(partial_sum) * num_sums) == 0)
+		result = mmap(NULL, sizeof(partial_sum) * num_sums, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	// the mapping keeps the file open
+	close(fd);
+	
+	return (result == MAP_FAILED) ? NULL : (partial_sum*) result;
+}
+
+// restores the heap property below position i, for a heap of runs ordered like the sorted sums
+static void sift_runs(run_head *heap, int heap_size, int i, int descending) {
+	while (1) {
+		int first = i;
+		for (int child=2*i+1; (child<=2*i+2) && (child<heap_size); child++) {
+			if (descending ? (heap[child].sum > heap[first].sum) : (heap[child].sum < heap[first].sum))
+				first = child;
+		}
+		if (first == i)
+			return;
+		run_head temp = heap[i];
+		heap[i] = heap[first];
+		heap[first] = temp;
+		i = first;
+	}
+}
+
+// same as get_sorted_sums, but the sums are kept in a memory-mapped temporary file, to be released by munmap
+// runs of run_sums sums, sharing the items above the first log2(run_sums), are built and radix sorted in memory,
+// and then merged in one streaming pass, so only the runs being built and the heap of runs take memory
+// returns NULL if the temporary files cannot be created, or the runs do not fit in memory
+static partial_sum *get_sorted_sums_external(int size, root_type *vals, int descending) {
+	assert(size < 31);
+	int num_sums = 1 << size;
+	int run_size = min(run_sums, num_sums);
+	int low_size = __builtin_ctz(run_size);
+	int num_runs = num_sums / run_size;
+	partial_sum *runs = map_temp_file(num_sums);
+	if (runs == NULL)
+		return NULL;
 	
-	// add huge last entries to list1 and list2 to avoid checking for the end of the list
-	list1[size] = DBL_MAX / 2.0;
-	list1[size] = DBL_MAX / 2.0;
-	// keep track of position in list 1 and 2
-	int list1_ind = 0, list2_ind = 0;
-	for (int i=0; i<2*size+1; i++) {
-		if (list1[list1_ind] <= list2[list2_ind]) {
-			result[i] = list1[list1_ind++];
+	// the sums of the low items are built once, and each run adds its high items to them in order,
+	// so each sum rounds as in get_sorted_sums
+	sums_job job;
+	job.descending = descending;
+	job.vals = vals;
+	job.num_sums = run_size;
+	partial_sum *low = (partial_sum*) malloc(sizeof(partial_sum) * run_size);
+	partial_sum *run = (partial_sum*) malloc(sizeof(partial_sum) * run_size);
+	partial_sum *temp = (partial_sum*) malloc(sizeof(partial_sum) * run_size);
+	if ((low == NULL) || (run == NULL) || (temp == NULL)) {
+		free(low);
+		free(run);
+		free(temp);
+		munmap(runs, sizeof(partial_sum) * num_sums);
+		return NULL;
+	}
+	job.src = low;
+	job.src[0].sum = 0;
+	job.src[0].mask = 0;
+	for (job.level=0; job.level<low_size; job.level++)
+		parallel_for(((1 << job.level) + SORT_BLOCK - 1) / SORT_BLOCK, extend_task, &job);
+	for (int r=0; r<num_runs; r++) {
+		memcpy(run, low, sizeof(partial_sum) * run_size);
+		for (int i=0; i<size-low_size; i++) {
+			if (!((r >> i) & 1))
+				continue;
+			root_type val = vals[low_size + i];
+			uint64_t bit = (uint64_t) 1 << (low_size + i);
+			for (int j=0; j<run_size; j++) {
+				run[j].sum += val;
+				run[j].mask |= bit;
+			}
+		}
+		job.src = run;
+		job.dst = temp;
+		radix_sort(&job);
+		memcpy(runs + (size_t) r * run_size, job.src, sizeof(partial_sum) * run_size);
+		run = job.src;
+		temp = job.dst;
+	}
+	free(low);
+	free(run);
+	free(temp);
+	if (num_runs == 1) {
+		madvise(runs, sizeof(partial_sum) * num_sums, MADV_SEQUENTIAL);
+		return runs;
+	}
+	
+	// each run is read in order, so the kernel can read ahead in all of them
+	partial_sum *result = map_temp_file(num_sums);
+	run_head *heap = (run_head*) malloc(sizeof(run_head) * num_runs);
+	if ((result == NULL) || (heap == NULL)) {
+		if (result != NULL)
+			munmap(result, sizeof(partial_sum) * num_sums);
+		free(heap);
+		munmap(runs, sizeof(partial_sum) * num_sums);
+		return NULL;
+	}
+	madvise(runs, sizeof(partial_sum) * num_sums, MADV_SEQUENTIAL);
+	madvise(result, sizeof(partial_sum) * num_sums, MADV_SEQUENTIAL);
+	for (int r=0; r<num_runs; r++) {
+		heap[r].sum = runs[(size_t) r * run_size].sum;
+		heap[r].run = r;
+		heap[r].pos = 0;
+	}
+	int heap_size = num_runs;
+	for (int i=heap_size/2-1; i>=0; i--)
+		sift_runs(heap, heap_size, i, descending);
+	for (int i=0; i<num_sums; i++) {
+		result[i] = runs[(size_t) heap[0].run * run_size + heap[0].pos];
+		if (++heap[0].pos < run_size) {
+			heap[0].sum = runs[(size_t) heap[0].run * run_size + heap[0].pos].sum;
 		} else {
-			result[i] = list2[list2_ind++];
+			heap[0] = heap[--heap_size];
 		}
+		sift_runs(heap, heap_size, 0, descending);
 	}
+	free(heap);
+	munmap(runs, sizeof(partial_sum) * num_sums);
 	
-	free(list1);
-	free(list2);
 	return result;
 }
 
-// used to get list of sorted sums of the two subsets
-static root_type *get_sorted_sums(int size, root_type *vals) {
-	int num_sums = 1;
-	root_type *list1 = (root_type*) malloc(sizeof(root_type) * (num_sums + 1));
-	list1[0] = 0;
-	for (int i=0; i<size; i++) {
-		root_type *list2 = (root_type*) malloc(sizeof(root_type) * (num_sums + 1));
-		for (int j=0; j<num_sums; j++)
-			list2[j] = list1[j] + vals[i];
-		list1 = merge_lists(num_sums, list1, list2);
-		num_sums *= 2;
+/* ---------- Meet in the Middle ---------- */
+
+// returns 1 if the search has been cancelled through the given flag, which may be NULL
+static int is_cancelled(int *cancelled) {
+	return (cancelled != NULL) && __atomic_load_n(cancelled, __ATOMIC_RELAXED);
+}
+
+// returns 1 if the subset (a1, a2) comes before (b1, b2) when their 0/1 indicator vectors are compared lexicographically
+static int precedes(uint64_t a1, uint64_t a2, uint64_t b1, uint64_t b2) {
+	uint64_t a = (a1 != b1) ? a1 : a2, b = (a1 != b1) ? b1 : b2;
+	if (a == b)
+		return 0;
+	// the lowest item in only one of the subsets decides
+	return ((a >> __builtin_ctzll(a ^ b)) & 1) == 0;
+}
+
+// the sorted sums of the two halves, shared by the tasks scanning blocks of the first half
+// the sums of the first half are in increasing order and those of the second half in decreasing order,
+// so that both lists are read forwards
+// each task records its results at its index
+typedef struct scan_job {
+	partial_sum *sums1, *sums2;
+	int num_sums1, num_sums2;
+	root_type sum, tolerance;
+	double *errors;
+	uint64_t *best1, *best2;
+	int *found;
+	int *cancelled;	// once set, the remaining blocks are skipped
+} scan_job;
+
+// returns the first index j of the decreasing sums for which sum - (partial + sums[j].sum) >= -slack, or num_sums if there is none
+static int first_not_above(partial_sum *sums, int num_sums, root_type sum, root_type partial, root_type slack) {
+	int low = 0, high = num_sums;
+	while (low < high) {
+		int mid = low + (high - low) / 2;
+		if (sum - (partial + sums[mid].sum) >= -slack) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+	return low;
+}
+
+// finds the smallest difference between sum and the sum of a subset whose first half is in the taskth block
+// for each sum of the first half, the closest sums of the second half are on either side of the sum it needs,
+// and the position of that moves along the second list as the first sum increases
+static void error_task(int task, int worker, void *arg) {
+	scan_job *job = (scan_job*) arg;
+	int start = task * SCAN_BLOCK, end = min(start + SCAN_BLOCK, job->num_sums1);
+	int ind2 = first_not_above(job->sums2, job->num_sums2, job->sum, job->sums1[start].sum, 0);
+	double smallest_err = DBL_MAX;
+	if (is_cancelled(job->cancelled))
+		end = start;
+	for (int ind1=start; ind1<end; ind1++) {
+		root_type partial = job->sums1[ind1].sum;
+		while ((ind2 < job->num_sums2) && (job->sum - (partial + job->sums2[ind2].sum) < 0))
+			ind2++;
+		if ((ind2 < job->num_sums2) && (fabs(job->sum - (partial + job->sums2[ind2].sum)) < smallest_err))
+			smallest_err = fabs(job->sum - (partial + job->sums2[ind2].sum));
+		if ((ind2 > 0) && (fabs(job->sum - (partial + job->sums2[ind2 - 1].sum)) < smallest_err))
+			smallest_err = fabs(job->sum - (partial + job->sums2[ind2 - 1].sum));
+	}
+	job->errors[task] = smallest_err;
+}
+
+// finds the first subset in lexicographic order within tolerance whose first half is in the taskth block
+// for each sum of the first half, the sums of the second half within tolerance form a run, found as in error_task
+static void certificate_task(int task, int worker, void *arg) {
+	scan_job *job = (scan_job*) arg;
+	int start = task * SCAN_BLOCK, end = min(start + SCAN_BLOCK, job->num_sums1);
+	int ind2 = first_not_above(job->sums2, job->num_sums2, job->sum, job->sums1[start].sum, job->tolerance);
+	job->found[task] = 0;
+	if (is_cancelled(job->cancelled))
+		end = start;
+	for (int ind1=start; (ind1<end) && (ind2<job->num_sums2); ind1++) {
+		// differences are computed as in error_task, so that the best subset is within tolerance despite rounding
+		root_type partial = job->sums1[ind1].sum;
+		while ((ind2 < job->num_sums2) && (job->sum - (partial + job->sums2[ind2].sum) < -job->tolerance))
+			ind2++;
+		for (int j=ind2; (j<job->num_sums2) && (job->sum - (partial + job->sums2[j].sum) <= job->tolerance); j++) {
+			if (!job->found[task] || precedes(job->sums1[ind1].mask, job->sums2[j].mask, job->best1[task], job->best2[task])) {
+				job->best1[task] = job->sums1[ind1].mask;
+				job->best2[task] = job->sums2[j].mask;
+				job->found[task] = 1;
+			}
+		}
 	}
-	return list1;
 }
 
 // returns smallest absolute difference between given sum and a subset sum
-// runs in O(2^(n/2)) time and space
-static double subset_sum(int size, root_type *vals, root_type sum) {
-	// the set is split into two equal-size subsets
+// if subset is not NULL, it is set to the indicator vector of the first subset in lexicographic order within EVAL_ERR of that
+// this is the subset found by greedily leaving out items in order while the smallest difference can still be reached
+// the sorted sums of the first half are divided into blocks, which are scanned against the second half by separate threads
+// if the flag cancelled is set during the search, the result is meaningless
+// if external is 1, the sorted sums are built out of core, and the scan reads them from disk in order,
+// and -1 is returned if they cannot be built
+// runs in O(2^(n/2)) time and space, plus the number of subsets within EVAL_ERR of the smallest difference
+static double subset_sum(int size, root_type *vals, root_type sum, int *subset, int *cancelled, int external) {
+	// the set is split into two equal-size subsets, whose sorted sums carry their masks
 	int size1 = size / 2;
 	int size2 = size - size1;
-	root_type *vals1 = (root_type*) malloc(sizeof(root_type) * size1);
-	root_type *vals2 = (root_type*) malloc(sizeof(root_type) * size2);
-	for (int i=0; i<size1; i++)
-		vals1[i] = vals[i];
-	for (int i=0; i<size2; i++)
-		vals2[i] = vals[i + size1];
+	scan_job job;
+	partial_sum *(*sorted_sums)(int, root_type *, int) = external ? get_sorted_sums_external : get_sorted_sums;
+	job.sums1 = sorted_sums(size1, vals, 0);
+	job.sums2 = sorted_sums(size2, vals + size1, 1);
+	if ((job.sums1 == NULL) || (job.sums2 == NULL)) {
+		if (job.sums1 != NULL)
+			munmap(job.sums1, sizeof(partial_sum) * ((size_t) 1 << size1));
+		if (job.sums2 != NULL)
+			munmap(job.sums2, sizeof(partial_sum) * ((size_t) 1 << size2));
+		return -1;
+	}
+	job.num_sums1 = 1 << size1;
+	job.num_sums2 = 1 << size2;
+	job.sum = sum;
+	job.cancelled = cancelled;
+	int num_blocks = (job.num_sums1 + SCAN_BLOCK - 1) / SCAN_BLOCK;
+	job.errors = (double*) malloc(sizeof(double) * num_blocks);
+	job.best1 = (uint64_t*) malloc(sizeof(uint64_t) * num_blocks);
+	job.best2 = (uint64_t*) malloc(sizeof(uint64_t) * num_blocks);
+	job.found = (int*) malloc(sizeof(int) * num_blocks);
 	
-	root_type *sorted_sums1 = get_sorted_sums(size1, vals1);
-	root_type *sorted_sums2 = get_sorted_sums(size2, vals2);
-	int num_sorted_sums1 = (int) round(pow(2.0, (double) size1));
-	int num_sorted_sums2 = (int) round(pow(2.0, (double) size2));
-	// vals no longer needed, so are freed
-	free(vals1);
-	free(vals2);
+	parallel_for(num_blocks, error_task, &job);
+	double smallest_err = DBL_MAX;
+	for (int i=0; i<num_blocks; i++) {
+		if (job.errors[i] < smallest_err)
+			smallest_err = job.errors[i];
+	}
+	
+	if ((subset != NULL) && !is_cancelled(cancelled)) {
+		job.tolerance = smallest_err + EVAL_ERR;
+		parallel_for(num_blocks, certificate_task, &job);
+		uint64_t best1 = 0, best2 = 0;
+		int found = 0;
+		for (int i=0; i<num_blocks; i++) {
+			if (job.found[i] && (!found || precedes(job.best1[i], job.best2[i], best1, best2))) {
+				best1 = job.best1[i];
+				best2 = job.best2[i];
+				found = 1;
+			}
+		}
+		for (int i=0; i<size1; i++)
+			subset[i] = (best1 >> i) & 1;
+		for (int i=0; i<size2; i++)
+			subset[size1 + i] = (best2 >> i) & 1;
+	}
 	
-	int ind1 = 0, ind2 = num_sorted_sums2 - 1;
+	if (external) {
+		munmap(job.sums1, sizeof(partial_sum) * job.num_sums1);
+		munmap(job.sums2, sizeof(partial_sum) * job.num_sums2);
+	} else {
+		free(job.sums1);
+		free(job.sums2);
+	}
+	free(job.errors);
+	free(job.best1);
+	free(job.best2);
+	free(job.found);
+	return smallest_err;
+}
+
+/* ---------- Schroeppel–Shamir ---------- */
+
+// a pair of indices into the sorted sums of two quarters of the items, ordered by the sum of the pair
+typedef struct sum_pair {
+	root_type sum;
+	int low_ind, high_ind;
+} sum_pair;
+
+// enumerates the sums of half of the items in sorted order, as sums of the sorted sums of its two quarters
+// the heap holds one pair per sum of the lower quarter, so only O(2^(n/4)) memory is used
+typedef struct sum_stream {
+	partial_sum *low, *high;	// sorted sums of the two quarters
+	int num_low, num_high;
+	int low_size;				// number of items in the lower quarter, by which masks of the upper quarter are shifted
+	int descending;				// 1 if sums are enumerated from largest to smallest
+	sum_pair *heap;
+	int heap_size;
+} sum_stream;
+
+// returns 1 if a is enumerated before b
+static int stream_precedes(sum_stream *stream, sum_pair a, sum_pair b) {
+	return stream->descending ? (a.sum > b.sum) : (a.sum < b.sum);
+}
+
+// restores the heap property below position i
+static void sift_down(sum_stream *stream, int i) {
+	while (1) {
+		int first = i, left = 2 * i + 1, right = 2 * i + 2;
+		if ((left < stream->heap_size) && stream_precedes(stream, stream->heap[left], stream->heap[first]))
+			first = left;
+		if ((right < stream->heap_size) && stream_precedes(stream, stream->heap[right], stream->heap[first]))
+			first = right;
+		if (first == i)
+			return;
+		sum_pair temp = stream->heap[i];
+		stream->heap[i] = stream->heap[first];
+		stream->heap[first] = temp;
+		i = first;
+	}
+}
+
+// pairs every sum of the lower quarter with the first sum of the upper quarter in the order of enumeration
+static void init_sum_stream(sum_stream *stream, int size, root_type *vals, int descending) {
+	stream->low_size = size / 2;
+	stream->low = get_sorted_sums(stream->low_size, vals, 0);
+	stream->high = get_sorted_sums(size - stream->low_size, vals + stream->low_size, 0);
+	stream->num_low = 1 << stream->low_size;
+	stream->num_high = 1 << (size - stream->low_size);
+	stream->descending = descending;
+	stream->heap = (sum_pair*) malloc(sizeof(sum_pair) * stream->num_low);
+	assert(stream->heap != NULL);
+	stream->heap_size = stream->num_low;
+	int high_ind = descending ? stream->num_high - 1 : 0;
+	for (int i=0; i<stream->num_low; i++) {
+		stream->heap[i].sum = stream->low[i].sum + stream->high[high_ind].sum;
+		stream->heap[i].low_ind = i;
+		stream->heap[i].high_ind = high_ind;
+	}
+	for (int i=stream->heap_size/2-1; i>=0; i--)
+		sift_down(stream, i);
+}
+
+static void free_sum_stream(sum_stream *stream) {
+	free(stream->low);
+	free(stream->high);
+	free(stream->heap);
+}
+
+// sets next to the next sum of the stream with its mask
+// returns 0 if the stream is exhausted and 1 otherwise
+static int next_sum(sum_stream *stream, partial_sum *next) {
+	if (stream->heap_size == 0)
+		return 0;
+	sum_pair *top = stream->heap;
+	next->sum = top->sum;
+	next->mask = stream->low[top->low_ind].mask | (stream->high[top->high_ind].mask << stream->low_size);
+	// replace the pair by its successor in the upper quarter, or drop it if there is none
+	top->high_ind += stream->descending ? -1 : 1;
+	if ((top->high_ind >= 0) && (top->high_ind < stream->num_high)) {
+		top->sum = stream->low[top->low_ind].sum + stream->high[top->high_ind].sum;
+	} else {
+		stream->heap[0] = stream->heap[--stream->heap_size];
+	}
+	sift_down(stream, 0);
+	return 1;
+}
+
+// same as subset_sum, but the sorted sums of each half are enumerated lazily from its two quarters
+// runs in O(2^(n/2) log(n)) time and O(2^(n/4)) space, plus the number of subsets within EVAL_ERR of the smallest difference
+static double schroeppel_shamir(int size, root_type *vals, root_type sum, int *subset, int *cancelled) {
+	int size1 = size / 2;
+	int size2 = size - size1;
+	sum_stream stream1, stream2;
+	init_sum_stream(&stream1, size1, vals, 0);
+	init_sum_stream(&stream2, size2, vals + size1, 1);
+	partial_sum sum1, sum2;
+	next_sum(&stream1, &sum1);
+	next_sum(&stream2, &sum2);
 	double smallest_err = DBL_MAX;
 	
 	while (1) {
-		root_type cur_dif = sum - (sorted_sums1[ind1] + sorted_sums2[ind2]);
+		root_type cur_dif = sum - (sum1.sum + sum2.sum);
 		if (fabs(cur_dif) < smallest_err)
 			smallest_err = fabs(cur_dif);
 		if (cur_dif > 0) {	// subset sum is too low
-			if (ind1 < num_sorted_sums1 - 1) {
-				ind1++;	// move to larger element of sorted_sums1
-			} else {
+			if (!next_sum(&stream1, &sum1))
 				break;	// finished searching
-			}
 		} else if (cur_dif < 0) {	// subset sum is too high
-			if (ind2 > 0) {
-				ind2--;	// move to smaller element of sorted_sums2
-			} else {
+			if (!next_sum(&stream2, &sum2))
 				break;	// finished searching
-			}
 		} else {	// subset sum is exactly given sum
 			break;
 		}
+		if (is_cancelled(cancelled))
+			break;
+	}
+	free_sum_stream(&stream1);
+	free_sum_stream(&stream2);
+	
+	if ((subset != NULL) && !is_cancelled(cancelled)) {
+		// the sums of the second half within tolerance of the current sum of the first half are kept in a window,
+		// which slides towards smaller sums as the streams are enumerated again
+		root_type tolerance = smallest_err + EVAL_ERR;
+		uint64_t best1 = 0, best2 = 0;
+		int found = 0;
+		int window_capacity = 16, window_start = 0, window_end = 0;
+		partial_sum *window = (partial_sum*) malloc(sizeof(partial_sum) * window_capacity);
+		init_sum_stream(&stream1, size1, vals, 0);
+		init_sum_stream(&stream2, size2, vals + size1, 1);
+		int has_sum2 = next_sum(&stream2, &sum2);
+		while (next_sum(&stream1, &sum1) && !is_cancelled(cancelled)) {
+			// drop the sums which are now too large
+			while ((window_start < window_end) && (sum - (sum1.sum + window[window_start].sum) < -tolerance))
+				window_start++;
+			while (has_sum2 && (sum - (sum1.sum + sum2.sum) < -tolerance))
+				has_sum2 = next_sum(&stream2, &sum2);
+			// add the sums which are now close enough
+			while (has_sum2 && (sum - (sum1.sum + sum2.sum) <= tolerance)) {
+				if (window_end == window_capacity) {
+					// shift the window to the front, growing it if it is full
+					window_end -= window_start;
+					memmove(window, window + window_start, sizeof(partial_sum) * window_end);
+					window_start = 0;
+					if (window_end == window_capacity) {
+						window_capacity *= 2;
+						window = (partial_sum*) realloc(window, sizeof(partial_sum) * window_capacity);
+						assert(window != NULL);
+					}
+				}
+				window[window_end++] = sum2;
+				has_sum2 = next_sum(&stream2, &sum2);
+			}
+			if (!has_sum2 && (window_start == window_end))
+				break;
+			for (int j=window_start; j<window_end; j++) {
+				if (!found || precedes(sum1.mask, window[j].mask, best1, best2)) {
+					best1 = sum1.mask;
+					best2 = window[j].mask;
+					found = 1;
+				}
+			}
+		}
+		free(window);
+		free_sum_stream(&stream1);
+		free_sum_stream(&stream2);
+		for (int i=0; i<size1; i++)
+			subset[i] = (best1 >> i) & 1;
+		for (int i=0; i<size2; i++)
+			subset[size1 + i] = (best2 >> i) & 1;
 	}
 	
-	free(sorted_sums1);
-	free(sorted_sums2);
 	return smallest_err;
 }
 
+/* ---------- Certificates ---------- */
+
+// returns about the most memory in bytes the meet-in-the-middle search takes for size items
+static size_t meet_in_the_middle_memory(int size) {
+	// sorting the sums of the second half takes twice their size, while those of the first half are held
+	return sizeof(partial_sum) * (((size_t) 1 << (size / 2)) + ((size_t) 2 << (size - size / 2)));
+}
+
+// returns 1 if the meet-in-the-middle search for size items would take more than SUBSET_SUM_MEMORY_LIMIT
+static int use_schroeppel_shamir(int size) {
+	return meet_in_the_middle_memory(size) > SUBSET_SUM_MEMORY_LIMIT;
+}
+
 // returns the subset which sums closest to error, in the form of a list of 0s and 1s indicating inclusion and exclusion
 // records the error in the passed error parameter
-// runs in O(2^(n/2)) time and space
+// runs in O(2^(n/2)) time and space, with a single meet-in-the-middle search
+// once that would take more than SUBSET_SUM_MEMORY_LIMIT, from 49 items on,
+// the Schroeppel–Shamir search is used, which needs only O(2^(n/4)) space
 int *subset_sum_certificate(subset_sum_problem problem, root_type *error) {
-	// initialize the set of indices being checked to all indices
+	return cancellable_subset_sum_certificate(problem, error, NULL);
+}
+
+// same as subset_sum_certificate, but the search stops soon after the flag cancelled is set by another thread
+// returns NULL if the search was cancelled
+int *cancellable_subset_sum_certificate(subset_sum_problem problem, root_type *error, int *cancelled) {
 	int *inds = (int*) malloc(sizeof(int) * problem.size);
-	for (int i=0; i<problem.size; i++)
-		inds[i] = 1;
-	
-	// the minimum acheivable error is that found searching the whole set
-	*error = subset_sum(problem.size, problem.items, problem.sum);
+	if (use_schroeppel_shamir(problem.size)) {
+		*error = schroeppel_shamir(problem.size, problem.items, problem.sum, inds, cancelled);
+	} else {
+		*error = subset_sum(problem.size, problem.items, problem.sum, inds, cancelled, 0);
+	}
+	if (is_cancelled(cancelled)) {
+		free(inds);
+		return NULL;
+	}
 	
-	// search through the tree of subsets, selecting the appropriate branch at each step using subset_sum
-	root_type *subset = malloc(sizeof(root_type) * problem.size);
-	int subset_size;
-	for (int i=0; i<problem.size; i++) {
-		subset_size = 0;
-		// first try leaving out the ith element
-		inds[i] = 0;
-		for (int j=0; j<problem.size; j++) {
-			if (inds[j] == 1)
-				subset[subset_size++] = problem.items[j];
-		}
-		// test if we can still get within error of sum
-		if (subset_sum(subset_size, subset, problem.sum) > *error + EVAL_ERR)
-			inds[i] = 1;	// if not, puts the ith element back in
+	return inds;
+}
+
+// same as subset_sum_certificate, but the sorted sums of the halves are kept in memory-mapped temporary files
+// in TMPDIR, or /tmp if it is not set, so the search is limited by disk rather than memory
+// memory use is O(2^(n/2) / EXTERNAL_RUN_SUMS) besides the runs being sorted, so problems of up to 60 items can be solved
+// returns NULL if the problem is larger than that, or the temporary files cannot be created or filled
+int *external_subset_sum_certificate(subset_sum_problem problem, root_type *error) {
+	if (problem.size > MAX_EXTERNAL_SIZE)
+		return NULL;
+	int *inds = (int*) malloc(sizeof(int) * problem.size);
+	*error = subset_sum(problem.size, problem.items, problem.sum, inds, NULL, 1);
+	if (*error < 0) {
+		free(inds);
+		return NULL;
 	}
 	
-	free(subset);
 	return inds;
 }
 
+// returns about the most memory in bytes subset_sum_certificate takes for a problem with size items
+size_t subset_sum_memory(int size) {
+	if (!use_schroeppel_shamir(size))
+		return meet_in_the_middle_memory(size);
+	// each of the two streams holds the sums of two quarters, sorted with a buffer of the same size, and a heap
+	return 2 * (4 * sizeof(partial_sum) + sizeof(sum_pair)) * ((size_t) 1 << ((size + 3) / 4));
+}
+
 // used only for testing
 // to test, run "make test subset_sum"
 #ifdef TEST_SUBSET_SUM
 
-// should output 0-19 in order
-void test_merge_lists() {
-	root_type *list1 = (root_type*) malloc(sizeof(root_type) * 11);
-	root_type *list2 = (root_type*) malloc(sizeof(root_type) * 11);
-	for (int i=0; i<10; i++) {
-		list1[i] = 2*i;
-		list2[i] = 2*i+1;
-	}
-	root_type *list3 = merge_lists(10, list1, list2);
-	printf("merge_lists: ");
-	for (int i=0; i<20; i++) {
-		printf("%lf\n", list3[i]);
+// should output -3.25, -3, -1.75, -1.5, -1.25, -1, -0.25, 0, 0.25, 0.5, 1.25, 1.5, 1.75, 2, 3.25, 3.5
+// then 1, as the sums of 18 items spanning several blocks are in order and each matches its mask
+void test_radix_sort() {
+	root_type signed_vals[4] = {-3, 1.5, -0.25, 2};
+	partial_sum *sorted_sums = get_sorted_sums(4, signed_vals, 0);
+	printf("radix_sort: %g", sorted_sums[0].sum);
+	for (int i=1; i<16; i++)
+		printf(", %g", sorted_sums[i].sum);
+	printf("\n");
+	free(sorted_sums);
+	root_type *list = (root_type*) malloc(sizeof(root_type) * 18);
+	for (int i=0; i<18; i++)
+		list[i] = sin((double) i) * (i + 1);
+	set_num_workers(4);
+	sorted_sums = get_sorted_sums(18, list, 0);
+	int sorted = 1;
+	for (int i=0; i<(1 << 18); i++) {
+		root_type sum = 0;
+		for (int j=0; j<18; j++) {
+			if ((sorted_sums[i].mask >> j) & 1)
+				sum += list[j];
+		}
+		sorted = sorted && (fabs(sum - sorted_sums[i].sum) < 1e-12) && ((i == 0) || (sorted_sums[i - 1].sum <= sorted_sums[i].sum));
 	}
+	printf("sorted: %d\n", sorted);
+	set_num_workers(0);
+	free(sorted_sums);
+	free(list);
 }
 
-// should output 0-15 in order
+// should output 0-15 in order, each with the mask of the powers of 2 summing to it
 void test_get_sorted_sums() {
 	root_type *list = (root_type*) malloc(sizeof(root_type) * 5);
 	list[0] = 1;
 	for (int i=1; i<4; i++) {
 		list[i] = 2*list[i-1];
 	}
-	root_type *sorted_sums = get_sorted_sums(4, list);
+	partial_sum *sorted_sums = get_sorted_sums(4, list, 0);
 	printf("subset_sum: ");
 	for (int i=0; i<16; i++) {
-		printf("%lf\n", (double) sorted_sums[i]);
+		printf("%lf %llu\n", (double) sorted_sums[i].sum, (unsigned long long) sorted_sums[i].mask);
 	}
 }
 
@@ -172,7 +753,7 @@ void test_subset_sum() {
 	for (int i=1; i<10; i++) {
 		list[i] = 2*list[i-1];
 	}
-	printf("subset_sum: %lf\n", subset_sum(10, list, (root_type) 10.1));
+	printf("subset_sum: %lf\n", subset_sum(10, list, (root_type) 10.1, NULL, NULL, 0));
 }
 
 // should output error of .1 and subset 0,0,1,0,0,1,1,0,0,0 
@@ -194,12 +775,88 @@ void test_subset_sum_certificate() {
 	printf("\n");
 }
 
+// should output error of .1 and subset 0,0,1,0,0,1,1,0,0,0
+// then 1, as both searches find the same error and subset for a problem with 24 items
+// then 0, 1, as the meet-in-the-middle search fits in SUBSET_SUM_MEMORY_LIMIT up to 48 items
+void test_schroeppel_shamir() {
+	root_type *list = (root_type*) malloc(sizeof(root_type) * 24);
+	list[0] = 1;
+	for (int i=1; i<10; i++) {
+		list[i] = 2*list[i-1];
+	}
+	int *subset = (int*) malloc(sizeof(int) * 24);
+	printf("schroeppel_shamir: Error: %lf\nSubset: ", schroeppel_shamir(10, list, (root_type) 100.1, subset, NULL));
+	printf("%d", subset[0]);
+	for (int i=1; i<10; i++)
+		printf(", %d", subset[i]);
+	printf("\n");
+	for (int i=0; i<24; i++)
+		list[i] = sqrt((double) (i + 2)) * (i % 3 + 1);
+	int *expected = (int*) malloc(sizeof(int) * 24);
+	int agrees = (subset_sum(24, list, (root_type) 40.5, expected, NULL, 0) == schroeppel_shamir(24, list, (root_type) 40.5, subset, NULL));
+	for (int i=0; i<24; i++)
+		agrees = agrees && (subset[i] == expected[i]);
+	printf("agrees: %d\n", agrees);
+	printf("use_schroeppel_shamir: %d, %d\n", use_schroeppel_shamir(48), use_schroeppel_shamir(49));
+}
+
+// should output error of .1 and subset 0,0,1,0,0,1,1,0,0,0
+// then 1, as the in-memory and out-of-core searches find the same error and subset for a problem with 24 items
+// then 1, as the search fails without a usable temporary directory or with more than 60 items
+void test_external_subset_sum_certificate() {
+	root_type *list = (root_type*) malloc(sizeof(root_type) * 24);
+	list[0] = 1;
+	for (int i=1; i<10; i++) {
+		list[i] = 2*list[i-1];
+	}
+	root_type error;
+	subset_sum_problem problem = {10, list, 100.1};
+	int *subset = external_subset_sum_certificate(problem, &error);
+	printf("external_subset_sum_certificate: Error: %lf\nSubset: %d", error, subset[0]);
+	for (int i=1; i<10; i++)
+		printf(", %d", subset[i]);
+	printf("\n");
+	free(subset);
+	// small runs, so that the sums of each half are merged from many of them
+	run_sums = 64;
+	for (int i=0; i<24; i++)
+		list[i] = sqrt((double) (i + 2)) * (i % 3 + 1);
+	problem.size = 24;
+	problem.sum = 40.5;
+	root_type expected_error;
+	int *expected = subset_sum_certificate(problem, &expected_error);
+	subset = external_subset_sum_certificate(problem, &error);
+	int agrees = (error == expected_error);
+	for (int i=0; i<24; i++)
+		agrees = agrees && (subset[i] == expected[i]);
+	printf("agrees: %d\n", agrees);
+	run_sums = EXTERNAL_RUN_SUMS;
+	free(subset);
+	char *directory = getenv("TMPDIR");
+	if (directory != NULL)
+		directory = strdup(directory);
+	setenv("TMPDIR", "/nonexistent/subset_sum", 1);
+	int fails = (external_subset_sum_certificate(problem, &error) == NULL);
+	if (directory != NULL)
+		setenv("TMPDIR", directory, 1);
+	else
+		unsetenv("TMPDIR");
+	free(directory);
+	problem.size = 61;
+	fails = fails && (external_subset_sum_certificate(problem, &error) == NULL);
+	printf("fails: %d\n", fails);
+	free(expected);
+	free(list);
+}
+
 // used to test all functions
 int main(int argc, char **argv) {
-	test_merge_lists();
+	test_radix_sort();
 	test_get_sorted_sums();
 	test_subset_sum();
 	test_subset_sum_certificate();
+	test_schroeppel_shamir();
+	test_external_subset_sum_certificate();
 	exit(0);
 }
 
@@ -3,6 +3,12 @@
 
 // get declaration of entry_type
 #include "precision.h"
+#include <stdint.h>
+#include <stddef.h>
+
+// most memory in bytes the meet-in-the-middle search may take before the certificate is found by the Schroeppel–Shamir search,
+// whose sorted sums take O(2^(n/4)) rather than O(2^(n/2)) memory but is slower
+#define SUBSET_SUM_MEMORY_LIMIT ((size_t) 1 << 30)
 
 typedef struct subset_sum_problem {
 	int size;
@@ -10,6 +16,21 @@ typedef struct subset_sum_problem {
 	root_type sum;
 } subset_sum_problem;
 
+// a subset of the items, as the sum of its items and a bitmask with bit i set if item i is included
+// other searches may use the mask to encode how the sum was formed
+typedef struct partial_sum {
+	root_type sum;
+	uint64_t mask;
+} partial_sum;
+
+void sort_sums(partial_sum *, int);
+
 int *subset_sum_certificate(subset_sum_problem, root_type *);
 
+int *cancellable_subset_sum_certificate(subset_sum_problem, root_type *, int *);
+
+int *external_subset_sum_certificate(subset_sum_problem, root_type *);
+
+size_t subset_sum_memory(int);
+
 #endif
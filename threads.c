@@ -0,0 +1,185 @@
+// threads.c
+// implements a persistent pool of worker threads
+// the thread calling parallel_for takes part in the work as worker 0
+
+#include "threads.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// the job currently being run by the pool
+typedef struct job {
+	task_function function;
+	void *arg;
+	int num_tasks;
+	int next_task;		// the next task index to be claimed
+	int participants;	// number of workers taking part, including the caller
+	int active;			// number of pool threads which have not finished the job
+	unsigned long generation;	// incremented for every new job
+} job;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t job_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t job_done = PTHREAD_COND_INITIALIZER;
+static job current_job;
+static int pool_size = 0;		// number of threads in the pool, not counting callers
+static int pool_busy = 0;		// set while a job is running
+static int requested_workers = 0;	// 0 means use every available processor
+
+// the index of the worker running on this thread, or -1 if it is not running a task
+static __thread int thread_worker_ind = -1;
+
+/* ---------- Worker Threads ---------- */
+
+// claims and runs tasks of the current job until none are left
+static void run_tasks(int worker) {
+	int task;
+	while ((task = __atomic_fetch_add(&current_job.next_task, 1, __ATOMIC_RELAXED)) < current_job.num_tasks) {
+		current_job.function(task, worker, current_job.arg);
+	}
+}
+
+static void *worker_loop(void *arg) {
+	int worker = (int) (long) arg;
+	thread_worker_ind = worker;
+	unsigned long seen_generation = 0;
+	pthread_mutex_lock(&pool_lock);
+	while (1) {
+		while (current_job.generation == seen_generation)
+			pthread_cond_wait(&job_ready, &pool_lock);
+		seen_generation = current_job.generation;
+		int participating = (worker < current_job.participants);
+		pthread_mutex_unlock(&pool_lock);
+		if (participating)
+			run_tasks(worker);
+		pthread_mutex_lock(&pool_lock);
+		if (--current_job.active == 0)
+			pthread_cond_signal(&job_done);
+	}
+
+	return NULL;
+}
+
+/* ---------- Configuration ---------- */
+
+// returns the number of workers parallel_for divides tasks between
+int num_workers() {
+	int result = requested_workers;
+	if (result <= 0)
+		result = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	if (result < 1)
+		result = 1;
+	if (result > MAX_WORKERS)
+		result = MAX_WORKERS;
+
+	return result;
+}
+
+// sets the number of workers, or restores the default of one per processor if n <= 0
+void set_num_workers(int n) {
+	pthread_mutex_lock(&pool_lock);
+	requested_workers = n;
+	pthread_mutex_unlock(&pool_lock);
+}
+
+// starts threads until the pool has n - 1 of them
+// must be called with pool_lock held
+static void grow_pool(int n) {
+	while (pool_size < n - 1) {
+		pthread_t thread;
+		pool_size++;
+		int failed = pthread_create(&thread, NULL, worker_loop, (void*) (long) pool_size);
+		if (failed) {
+			pool_size--;
+			return;
+		}
+		pthread_detach(thread);
+	}
+}
+
+/* ---------- Parallel Loops ---------- */
+
+// runs function(i, worker, arg) for i = 0,...,num_tasks-1, dividing the tasks between the workers
+// returns once every task has finished
+// nested calls, and calls made while the pool is busy, run their tasks on the calling thread
+void parallel_for(int num_tasks, task_function function, void *arg) {
+	int workers = num_workers();
+	pthread_mutex_lock(&pool_lock);
+	if ((workers == 1) || (num_tasks <= 1) || pool_busy || (thread_worker_ind >= 0)) {
+		pthread_mutex_unlock(&pool_lock);
+		int worker = (thread_worker_ind >= 0) ? thread_worker_ind : 0;
+		for (int i=0; i<num_tasks; i++)
+			function(i, worker, arg);
+		return;
+	}
+	grow_pool(workers);
+	pool_busy = 1;
+	current_job.function = function;
+	current_job.arg = arg;
+	current_job.num_tasks = num_tasks;
+	current_job.next_task = 0;
+	current_job.participants = (workers < pool_size + 1) ? workers : pool_size + 1;
+	current_job.active = pool_size;
+	current_job.generation++;
+	pthread_cond_broadcast(&job_ready);
+	pthread_mutex_unlock(&pool_lock);
+
+	thread_worker_ind = 0;
+	run_tasks(0);
+	thread_worker_ind = -1;
+
+	pthread_mutex_lock(&pool_lock);
+	while (current_job.active > 0)
+		pthread_cond_wait(&job_done, &pool_lock);
+	pool_busy = 0;
+	pthread_mutex_unlock(&pool_lock);
+}
+
+/* ---------- Testing ---------- */
+// to test, run "make test threads"
+
+#ifdef TEST_THREADS
+#define NUM_TEST_TASKS 1000
+
+static void square_task(int task, int worker, void *arg) {
+	long *results = (long*) arg;
+	results[task] = (long) task * task;
+}
+
+// adds up the squares computed by the tasks of an outer loop, each of which runs a nested loop
+static void nested_task(int task, int worker, void *arg) {
+	long *results = (long*) arg;
+	long *squares = (long*) malloc(sizeof(long) * NUM_TEST_TASKS);
+	parallel_for(NUM_TEST_TASKS, square_task, squares);
+	results[task] = 0;
+	for (int i=0; i<NUM_TEST_TASKS; i++)
+		results[task] += squares[i];
+	free(squares);
+}
+
+/* should output:
+ * parallel_for: 332833500
+ * nested parallel_for: 332833500 */
+void test_parallel_for() {
+	set_num_workers(4);
+	long *results = (long*) malloc(sizeof(long) * NUM_TEST_TASKS);
+	parallel_for(NUM_TEST_TASKS, square_task, results);
+	long sum = 0;
+	for (int i=0; i<NUM_TEST_TASKS; i++)
+		sum += results[i];
+	printf("parallel_for: %ld\n", sum);
+	parallel_for(8, nested_task, results);
+	for (int i=1; i<8; i++)
+		assert(results[i] == results[0]);
+	printf("nested parallel_for: %ld\n", results[0]);
+	free(results);
+}
+
+int main(int argc, char **argv) {
+	test_parallel_for();
+	exit(0);
+}
+
+#endif
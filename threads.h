@@ -0,0 +1,19 @@
+// threads.h
+// a pool of worker threads for running independent tasks in parallel
+
+#ifndef THREADS_H
+#define THREADS_H
+
+#define MAX_WORKERS 64
+
+// a task is given its index and the index of the worker running it, which is in [0, num_workers())
+// worker indices can be used to select per-thread scratch space
+typedef void (*task_function)(int task, int worker, void *arg);
+
+int num_workers();
+
+void set_num_workers(int);
+
+void parallel_for(int, task_function, void *);
+
+#endif